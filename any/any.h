@@ -1,8 +1,13 @@
 #ifndef ANY_H
 #define ANY_H
 
-#include <memory>
+#include <cstddef>
+#include <functional>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 
 class BadAnyCast : public std::bad_cast {
  public:
@@ -11,41 +16,176 @@ class BadAnyCast : public std::bad_cast {
   }
 };
 
-class Any {
+// Identifies a type by the address of a static tag, so comparing two ids is a single pointer comparison and
+// needs no RTTI. Ids are ordered and hashable, so they can key dispatch tables. The tag is deliberately a
+// writable object: identical read-only constants may be folded to one address by the linker.
+class TypeId {
  private:
   template <typename T>
-  friend T AnyCast(const Any& value);
-
-  class IHolder {
-   public:
-    virtual ~IHolder() = default;
-    virtual std::shared_ptr<IHolder> Clone() = 0;
+  struct Tag {
+    static inline char tag;
   };
 
+  const void* tag_;
+
+  explicit constexpr TypeId(const void* tag) : tag_{tag} {
+  }
+
  public:
-  Any() : pointer_{nullptr} {
+  template <typename T>
+  static constexpr TypeId Of() {
+    return TypeId(&Tag<std::remove_cv_t<std::remove_reference_t<T>>>::tag);
   }
 
+  std::size_t Hash() const {
+    return std::hash<const void*>{}(tag_);
+  }
+
+  friend constexpr bool operator==(TypeId lhs, TypeId rhs) {
+    return lhs.tag_ == rhs.tag_;
+  }
+
+  friend constexpr bool operator!=(TypeId lhs, TypeId rhs) {
+    return lhs.tag_ != rhs.tag_;
+  }
+
+  friend bool operator<(TypeId lhs, TypeId rhs) {
+    return std::less<const void*>{}(lhs.tag_, rhs.tag_);
+  }
+};
+
+struct TypeIdHash {
+  std::size_t operator()(TypeId id) const {
+    return id.Hash();
+  }
+};
+
+// Values of up to three pointers that are nothrow-movable live inside the Any itself; larger ones are kept on
+// the heap. Either way the value is managed through a static table of functions for its type, so moving an
+// Any never allocates and never throws.
+class Any {
+ private:
+  static constexpr std::size_t kBufferSize = 3 * sizeof(void*);
+
+  union Storage {
+    alignas(void*) unsigned char buffer[kBufferSize];
+    void* heap;
+  };
+
+  template <typename T>
+  static constexpr bool kFitsInline = sizeof(T) <= kBufferSize && alignof(void*) % alignof(T) == 0 &&
+                                      std::is_nothrow_move_constructible_v<T>;
+
+  struct Ops {
+    void (*destroy)(Storage& storage) noexcept;
+    void (*copy)(const Storage& from, Storage& to);
+    // Moves the value and leaves from without one.
+    void (*move)(Storage& from, Storage& to) noexcept;
+    TypeId type;
+  };
+
+  template <typename T>
+  struct InlineOps {
+    static T* Get(Storage& storage) noexcept {
+      return std::launder(reinterpret_cast<T*>(storage.buffer));
+    }
+
+    static void Destroy(Storage& storage) noexcept {
+      Get(storage)->~T();
+    }
+
+    static void Copy(const Storage& from, Storage& to) {
+      new (to.buffer) T(*Get(const_cast<Storage&>(from)));
+    }
+
+    static void Move(Storage& from, Storage& to) noexcept {
+      new (to.buffer) T(std::move(*Get(from)));
+      Destroy(from);
+    }
+
+    static constexpr Ops kOps{&Destroy, &Copy, &Move, TypeId::Of<T>()};
+  };
+
   template <typename T>
+  struct HeapOps {
+    static T* Get(Storage& storage) noexcept {
+      return static_cast<T*>(storage.heap);
+    }
+
+    static void Destroy(Storage& storage) noexcept {
+      delete Get(storage);
+    }
+
+    static void Copy(const Storage& from, Storage& to) {
+      to.heap = new T(*static_cast<const T*>(from.heap));
+    }
+
+    static void Move(Storage& from, Storage& to) noexcept {
+      to.heap = from.heap;
+      from.heap = nullptr;
+    }
+
+    static constexpr Ops kOps{&Destroy, &Copy, &Move, TypeId::Of<T>()};
+  };
+
+  template <typename T>
+  using OpsFor = std::conditional_t<kFitsInline<T>, InlineOps<T>, HeapOps<T>>;
+
+  template <typename T>
+  using EnableIfValue = std::enable_if_t<!std::is_same_v<std::decay_t<T>, Any>>;
+
+  const Ops* ops_ = nullptr;
+  Storage storage_;
+
+  template <typename T>
+  friend T* AnyCast(Any* value) noexcept;
+
+  // A type always uses the same table, so the table address doubles as the type check.
+  template <typename T>
+  T* Get() noexcept {
+    if (ops_ != &OpsFor<T>::kOps) {
+      return nullptr;
+    }
+    return OpsFor<T>::Get(storage_);
+  }
+
+ public:
+  Any() = default;
+
+  template <typename T, typename = EnableIfValue<T>>
   Any(T&& other) {  // NOLINT
-    pointer_ = std::make_shared<AnyHolder<T>>(std::forward<T>(other));
+    using Value = std::decay_t<T>;
+    if constexpr (kFitsInline<Value>) {
+      new (storage_.buffer) Value(std::forward<T>(other));
+    } else {
+      storage_.heap = new Value(std::forward<T>(other));
+    }
+    ops_ = &OpsFor<Value>::kOps;
   }
 
-  template <typename T>
+  template <typename T, typename = EnableIfValue<T>>
   Any& operator=(T&& other) {
     Any(std::forward<T>(other)).Swap(*this);
     return *this;
   }
 
-  ~Any() = default;
+  ~Any() {
+    Reset();
+  }
 
   Any(const Any& other) {
-    pointer_ = other.pointer_->Clone();
+    if (other.ops_) {
+      other.ops_->copy(other.storage_, storage_);
+      ops_ = other.ops_;
+    }
   }
 
   Any(Any&& other) noexcept {
-    pointer_ = other.pointer_->Clone();
-    other.pointer_ = nullptr;
+    if (other.ops_) {
+      other.ops_->move(other.storage_, storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
   }
 
   Any& operator=(const Any& other) {
@@ -53,52 +193,101 @@ class Any {
     return *this;
   }
 
-  Any& operator=(Any& other) {
-    *this = static_cast<const Any&>(other);
-    return *this;
-  }
-
   Any& operator=(Any&& other) noexcept {
     Any(std::move(other)).Swap(*this);
     return *this;
   }
 
-  void Swap(Any& other) {
-    std::swap(pointer_, other.pointer_);
+  void Swap(Any& other) noexcept {
+    if (this == &other) {
+      return;
+    }
+    Any temp(std::move(other));
+    if (ops_) {
+      ops_->move(storage_, other.storage_);
+      other.ops_ = ops_;
+      ops_ = nullptr;
+    }
+    if (temp.ops_) {
+      temp.ops_->move(temp.storage_, storage_);
+      ops_ = temp.ops_;
+      temp.ops_ = nullptr;
+    }
   }
 
   void Reset() noexcept {
-    pointer_.reset();
+    if (ops_) {
+      ops_->destroy(storage_);
+      ops_ = nullptr;
+    }
   }
 
   bool HasValue() const noexcept {
-    return static_cast<bool>(pointer_);
+    return ops_ != nullptr;
   }
 
-  template <typename T>
-  class AnyHolder : public IHolder {
-   public:
-    T data_;
+  // TypeId::Of<void>() when empty.
+  TypeId Type() const noexcept {
+    return ops_ ? ops_->type : TypeId::Of<void>();
+  }
 
-    AnyHolder(T&& other) : data_{std::forward<T>(other)} {  // NOLINT
-    }
+  template <typename T>
+  bool Holds() const noexcept {
+    return ops_ == &OpsFor<std::remove_cv_t<T>>::kOps;
+  }
+};
 
-    std::shared_ptr<IHolder> Clone() override {
-      return std::make_shared<AnyHolder<T>>(std::forward<T>(data_));
-    }
-  };
+// Pointer to the stored value, or nullptr if value is null or holds another type.
+template <typename T>
+T* AnyCast(Any* value) noexcept {
+  static_assert(!std::is_reference_v<T>, "AnyCast to a pointer needs a non-reference type");
+  if (value == nullptr) {
+    return nullptr;
+  }
+  return value->Get<std::remove_cv_t<T>>();
+}
 
- private:
-  std::shared_ptr<IHolder> pointer_;
-};
+template <typename T>
+const T* AnyCast(const Any* value) noexcept {
+  return AnyCast<T>(const_cast<Any*>(value));
+}
 
+// T may be a value type (the stored value is copied) or a reference to the stored type. Throws BadAnyCast on
+// a type mismatch.
 template <typename T>
 T AnyCast(const Any& value) {
-  auto temp = dynamic_cast<Any::AnyHolder<T>*>(value.pointer_.get());
-  if (temp) {
-    return static_cast<T>(temp->data_);
+  using Value = std::remove_cv_t<std::remove_reference_t<T>>;
+  static_assert(std::is_constructible_v<T, const Value&>, "AnyCast cannot bind a const Any to this type");
+  const auto* data = AnyCast<Value>(&value);
+  if (data) {
+    return static_cast<T>(*data);
+  }
+  throw BadAnyCast{};
+}
+
+template <typename T>
+T AnyCast(Any& value) {
+  using Value = std::remove_cv_t<std::remove_reference_t<T>>;
+  auto* data = AnyCast<Value>(&value);
+  if (data) {
+    return static_cast<T>(*data);
+  }
+  throw BadAnyCast{};
+}
+
+// Casting an rvalue to a value type moves the stored value out.
+template <typename T>
+T AnyCast(Any&& value) {
+  using Value = std::remove_cv_t<std::remove_reference_t<T>>;
+  auto* data = AnyCast<Value>(&value);
+  if (data) {
+    if constexpr (std::is_reference_v<T>) {
+      return static_cast<T>(*data);
+    } else {
+      return static_cast<T>(std::move(*data));
+    }
   }
   throw BadAnyCast{};
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,401 @@
+#ifndef ANY_VECTOR_H
+#define ANY_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../any/any.h"
+#include "../vector/vector.h"
+
+class AnyVectorOutOfRange : public std::out_of_range {
+ public:
+  AnyVectorOutOfRange() : std::out_of_range("AnyVectorOutOfRange") {
+  }
+};
+
+// Non-owning view of size contiguous values.
+template <typename T>
+class Span {
+ private:
+  T* data_ = nullptr;
+  std::size_t size_ = 0;
+
+ public:
+  Span() = default;
+
+  Span(T* data, std::size_t size) : data_{data}, size_{size} {
+  }
+
+  T* Data() const {
+    return data_;
+  }
+
+  std::size_t Size() const {
+    return size_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  T& operator[](std::size_t index) const {
+    return data_[index];
+  }
+
+  T* begin() const {  // NOLINT
+    return data_;
+  }
+
+  T* end() const {  // NOLINT
+    return data_ + size_;
+  }
+};
+
+// Sequence of values whose types are known only at run time. Consecutive values of the same type are stored as
+// one run: a plain array with a single type tag, so typed scans over a run touch contiguous memory and check
+// the type once instead of per element. Appending a value of a different type starts a new run; indexing finds
+// the run by binary search over run offsets.
+class AnyVector {
+ public:
+  class Run;
+
+ private:
+  struct RunOps {
+    void (*destroy)(Run& run) noexcept;
+    void (*copy)(const Run& from, Run& to);
+    void (*pop)(Run& run) noexcept;
+    Any (*get)(const Run& run, std::size_t index);
+    TypeId type;
+  };
+
+  template <typename T>
+  struct OpsFor {
+    static T* Data(const Run& run) noexcept {
+      return static_cast<T*>(run.data_);
+    }
+
+    static void Destroy(Run& run) noexcept {
+      std::destroy(Data(run), Data(run) + run.size_);
+      std::allocator<T>().deallocate(Data(run), run.capacity_);
+      run.data_ = nullptr;
+      run.size_ = 0;
+      run.capacity_ = 0;
+    }
+
+    static void Copy(const Run& from, Run& to) {
+      to.data_ = std::allocator<T>().allocate(from.size_);
+      to.capacity_ = from.size_;
+      try {
+        std::uninitialized_copy(Data(from), Data(from) + from.size_, Data(to));
+      } catch (...) {
+        std::allocator<T>().deallocate(Data(to), to.capacity_);
+        to.data_ = nullptr;
+        to.capacity_ = 0;
+        throw;
+      }
+      to.size_ = from.size_;
+    }
+
+    // Reallocates the run to hold capacity values and appends T(args...). The new value is constructed before the
+    // old ones are moved, so args may refer to a value in the run.
+    template <typename... Args>
+    static void GrowAndEmplace(Run& run, std::size_t capacity, Args&&... args) {
+      T* data = std::allocator<T>().allocate(capacity);
+      try {
+        new (data + run.size_) T(std::forward<Args>(args)...);
+      } catch (...) {
+        std::allocator<T>().deallocate(data, capacity);
+        throw;
+      }
+      try {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+          std::uninitialized_move(Data(run), Data(run) + run.size_, data);
+        } else {
+          std::uninitialized_copy(Data(run), Data(run) + run.size_, data);
+        }
+      } catch (...) {
+        std::destroy_at(data + run.size_);
+        std::allocator<T>().deallocate(data, capacity);
+        throw;
+      }
+      std::destroy(Data(run), Data(run) + run.size_);
+      std::allocator<T>().deallocate(Data(run), run.capacity_);
+      run.data_ = data;
+      run.capacity_ = capacity;
+    }
+
+    static void Pop(Run& run) noexcept {
+      --run.size_;
+      std::destroy_at(Data(run) + run.size_);
+    }
+
+    static Any Get(const Run& run, std::size_t index) {
+      return Any(Data(run)[index]);
+    }
+
+    static constexpr RunOps kOps{&Destroy, &Copy, &Pop, &Get, TypeId::Of<T>()};
+  };
+
+ public:
+  // A maximal block of consecutive values of one type.
+  class Run {
+   private:
+    const RunOps* ops_;
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+    std::size_t offset_;  // index of the first value in the vector
+
+    friend class AnyVector;
+
+    Run(const RunOps* ops, std::size_t offset) : ops_{ops}, offset_{offset} {
+    }
+
+   public:
+    Run(Run&& other) noexcept = default;
+    Run& operator=(Run&& other) = delete;
+
+    TypeId Type() const {
+      return ops_->type;
+    }
+
+    template <typename T>
+    bool Holds() const {
+      return ops_ == &OpsFor<T>::kOps;
+    }
+
+    std::size_t Size() const {
+      return size_;
+    }
+
+    std::size_t Offset() const {
+      return offset_;
+    }
+
+    // Throws BadAnyCast unless the run holds T.
+    template <typename T>
+    Span<T> As() {
+      if (!Holds<T>()) {
+        throw BadAnyCast{};
+      }
+      return Span<T>(static_cast<T*>(data_), size_);
+    }
+
+    template <typename T>
+    Span<const T> As() const {
+      if (!Holds<T>()) {
+        throw BadAnyCast{};
+      }
+      return Span<const T>(static_cast<const T*>(data_), size_);
+    }
+  };
+
+ private:
+  Vector<Run> runs_;
+  std::size_t size_ = 0;
+
+  // Throws AnyVectorOutOfRange if index is not below Size().
+  Run& FindRun(std::size_t index) {
+    if (index >= size_) {
+      throw AnyVectorOutOfRange{};
+    }
+    if (runs_.Size() == 1) {
+      return runs_[0];
+    }
+    auto it = std::upper_bound(runs_.begin(), runs_.end(), index,
+                               [](std::size_t value, const Run& run) { return value < run.offset_; });
+    return *(it - 1);
+  }
+
+  const Run& FindRun(std::size_t index) const {
+    return const_cast<AnyVector*>(this)->FindRun(index);
+  }
+
+ public:
+  AnyVector() = default;
+
+  AnyVector(const AnyVector& other) {
+    runs_.Reserve(other.runs_.Size());
+    try {
+      for (const Run& run : other.runs_) {
+        runs_.PushBack(Run(run.ops_, run.offset_));
+        run.ops_->copy(run, runs_.Back());
+      }
+    } catch (...) {
+      Clear();
+      throw;
+    }
+    size_ = other.size_;
+  }
+
+  AnyVector(AnyVector&& other) noexcept : runs_{std::move(other.runs_)}, size_{other.size_} {
+    other.size_ = 0;
+  }
+
+  AnyVector& operator=(const AnyVector& other) {
+    if (this != &other) {
+      AnyVector temp(other);
+      Swap(temp);
+    }
+    return *this;
+  }
+
+  AnyVector& operator=(AnyVector&& other) noexcept {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+
+  ~AnyVector() {
+    Clear();
+  }
+
+  void Swap(AnyVector& other) noexcept {
+    runs_.Swap(other.runs_);
+    std::swap(size_, other.size_);
+  }
+
+  std::size_t Size() const {
+    return size_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  std::size_t RunCount() const {
+    return runs_.Size();
+  }
+
+  Span<Run> Runs() {
+    return Span<Run>(runs_.Data(), runs_.Size());
+  }
+
+  Span<const Run> Runs() const {
+    return Span<const Run>(runs_.Data(), runs_.Size());
+  }
+
+  template <typename T, typename... Args>
+  T& EmplaceBack(Args&&... args) {
+    static_assert(std::is_same_v<T, std::decay_t<T>>, "AnyVector stores decayed value types");
+    if (runs_.Empty() || !runs_.Back().Holds<T>()) {
+      runs_.PushBack(Run(&OpsFor<T>::kOps, size_));
+    }
+    Run& run = runs_.Back();
+    try {
+      if (run.size_ == run.capacity_) {
+        OpsFor<T>::GrowAndEmplace(run, std::max<std::size_t>(4, run.capacity_ * 2), std::forward<Args>(args)...);
+      } else {
+        new (static_cast<T*>(run.data_) + run.size_) T(std::forward<Args>(args)...);
+      }
+    } catch (...) {
+      if (run.size_ == 0) {
+        OpsFor<T>::Destroy(run);
+        runs_.PopBack();
+      }
+      throw;
+    }
+    ++run.size_;
+    ++size_;
+    return static_cast<T*>(run.data_)[run.size_ - 1];
+  }
+
+  template <typename T>
+  void PushBack(T&& value) {
+    EmplaceBack<std::decay_t<T>>(std::forward<T>(value));
+  }
+
+  void PopBack() {
+    if (size_ != 0) {
+      Run& run = runs_.Back();
+      run.ops_->pop(run);
+      --size_;
+      if (run.size_ == 0) {
+        run.ops_->destroy(run);
+        runs_.PopBack();
+      }
+    }
+  }
+
+  void Clear() {
+    for (Run& run : runs_) {
+      run.ops_->destroy(run);
+    }
+    runs_.Clear();
+    size_ = 0;
+  }
+
+  // Element accessors throw AnyVectorOutOfRange for an index not below Size().
+
+  TypeId Type(std::size_t index) const {
+    return FindRun(index).Type();
+  }
+
+  // Pointer to the value at index, or nullptr if it is not a T.
+  template <typename T>
+  T* GetIf(std::size_t index) {
+    Run& run = FindRun(index);
+    if (!run.Holds<T>()) {
+      return nullptr;
+    }
+    return static_cast<T*>(run.data_) + (index - run.offset_);
+  }
+
+  template <typename T>
+  const T* GetIf(std::size_t index) const {
+    return const_cast<AnyVector*>(this)->GetIf<T>(index);
+  }
+
+  // Throws BadAnyCast if the value at index is not a T.
+  template <typename T>
+  T& Get(std::size_t index) {
+    T* value = GetIf<T>(index);
+    if (value == nullptr) {
+      throw BadAnyCast{};
+    }
+    return *value;
+  }
+
+  template <typename T>
+  const T& Get(std::size_t index) const {
+    return const_cast<AnyVector*>(this)->Get<T>(index);
+  }
+
+  // Copy of the value at index, for callers that do not know its type.
+  Any At(std::size_t index) const {
+    const Run& run = FindRun(index);
+    return run.ops_->get(run, index - run.offset_);
+  }
+
+  // All values as one contiguous span. Throws BadAnyCast unless every value is a T.
+  template <typename T>
+  Span<T> As() {
+    if (runs_.Empty()) {
+      return {};
+    }
+    if (runs_.Size() != 1) {
+      throw BadAnyCast{};
+    }
+    return runs_[0].As<T>();
+  }
+
+  template <typename T>
+  Span<const T> As() const {
+    if (runs_.Empty()) {
+      return {};
+    }
+    if (runs_.Size() != 1) {
+      throw BadAnyCast{};
+    }
+    return runs_[0].As<T>();
+  }
+};
+
+#endif
@@ -0,0 +1,143 @@
+// g++ -std=c++17 -fsanitize=address,undefined any_vector/any_vector_test.cpp -o any_vector_test
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "any_vector.h"
+
+namespace {
+
+template <typename F>
+bool ThrowsOutOfRange(F&& f) {
+  try {
+    f();
+  } catch (const AnyVectorOutOfRange&) {
+    return true;
+  }
+  return false;
+}
+
+void EmptyIndex() {
+  AnyVector values;
+  const AnyVector& view = values;
+  assert(ThrowsOutOfRange([&] { values.Type(0); }));
+  assert(ThrowsOutOfRange([&] { values.GetIf<int>(0); }));
+  assert(ThrowsOutOfRange([&] { values.Get<int>(0); }));
+  assert(ThrowsOutOfRange([&] { view.Get<int>(0); }));
+  assert(ThrowsOutOfRange([&] { values.At(0); }));
+  assert(values.As<int>().Empty());
+}
+
+void OutOfRangeIndex() {
+  AnyVector values;
+  for (int i = 0; i != 10; ++i) {
+    values.PushBack(i);
+  }
+  assert(ThrowsOutOfRange([&] { values.Get<int>(10); }));
+  assert(ThrowsOutOfRange([&] { values.GetIf<int>(100); }));
+  values.PushBack(std::string("tail"));
+  assert(ThrowsOutOfRange([&] { values.Type(11); }));
+  assert(ThrowsOutOfRange([&] { values.Get<std::string>(11); }));
+  assert(ThrowsOutOfRange([&] { values.At(11); }));
+  assert(values.Get<std::string>(10) == "tail");
+  values.PopBack();
+  assert(ThrowsOutOfRange([&] { values.Get<std::string>(10); }));
+}
+
+void MixedRuns() {
+  AnyVector values;
+  for (int i = 0; i != 100; ++i) {
+    values.PushBack(i);
+  }
+  long sum = 0;
+  for (int x : values.As<int>()) {
+    sum += x;
+  }
+  assert(sum == 4950 && values.RunCount() == 1);
+  values.PushBack(std::string("a"));
+  values.PushBack(1.5);
+  values.PushBack(7);
+  assert(values.RunCount() == 4 && values.Size() == 103);
+  assert(values.Get<int>(42) == 42 && values.Get<std::string>(100) == "a" && values.Get<double>(101) == 1.5);
+  assert(values.GetIf<double>(0) == nullptr && values.Type(100) == TypeId::Of<std::string>());
+  assert(AnyCast<int>(values.At(102)) == 7);
+  bool mixed = false;
+  try {
+    values.As<int>();
+  } catch (const BadAnyCast&) {
+    mixed = true;
+  }
+  assert(mixed);
+  AnyVector copy = values;
+  copy.Get<int>(0) = 9;
+  assert(values.Get<int>(0) == 0 && copy.Get<int>(0) == 9);
+}
+
+// Appending a value of the vector itself when the run is full, so the run reallocates first.
+void SelfAliasingAtCapacity() {
+  AnyVector values;
+  for (int i = 0; i != 4; ++i) {
+    values.PushBack(std::string(32, static_cast<char>('a' + i)));
+  }
+  values.PushBack(values.Get<std::string>(0));
+  values.EmplaceBack<std::string>(std::move(values.Get<std::string>(1)));
+  for (int i = 6; i != 8; ++i) {
+    values.PushBack(values.Get<std::string>(3));
+  }
+  values.PushBack(values.Get<std::string>(7));
+  assert(values.Size() == 9 && values.RunCount() == 1);
+  assert(values.Get<std::string>(4) == std::string(32, 'a'));
+  assert(values.Get<std::string>(5) == std::string(32, 'b') && values.Get<std::string>(1).empty());
+  assert(values.Get<std::string>(8) == std::string(32, 'd'));
+}
+
+struct ThrowingCopy {
+  static inline int copies_left = 0;
+  int value;
+
+  explicit ThrowingCopy(int v) : value{v} {
+  }
+
+  ThrowingCopy(const ThrowingCopy& other) : value{other.value} {
+    if (copies_left-- == 0) {
+      throw std::runtime_error("copy");
+    }
+  }
+};
+
+// A failed append at capacity leaves the vector as it was, whether the new value or a relocation throws.
+void ThrowDuringGrow() {
+  AnyVector values;
+  for (int i = 0; i != 4; ++i) {
+    values.EmplaceBack<ThrowingCopy>(i);
+  }
+  for (int copies : {0, 2}) {
+    ThrowingCopy::copies_left = copies;
+    bool thrown = false;
+    try {
+      values.PushBack(values.Get<ThrowingCopy>(3));
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown && values.Size() == 4);
+    for (int i = 0; i != 4; ++i) {
+      assert(values.Get<ThrowingCopy>(i).value == i);
+    }
+  }
+  ThrowingCopy::copies_left = 5;
+  values.PushBack(values.Get<ThrowingCopy>(3));
+  assert(values.Size() == 5 && values.Get<ThrowingCopy>(4).value == 3);
+}
+
+}  // namespace
+
+int main() {
+  EmptyIndex();
+  OutOfRangeIndex();
+  MixedRuns();
+  SelfAliasingAtCapacity();
+  ThrowDuringGrow();
+  std::puts("OK");
+}
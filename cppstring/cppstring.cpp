@@ -1,15 +1,21 @@
 #include "cppstring.h"
 
+#include <charconv>
+
 String::String() : string_{nullptr}, size_{0}, capacity_{0} {
 }
 
-String::String(std::size_t size, char symbol) {
+String::String(const allocator_type& allocator)
+    : string_{nullptr}, size_{0}, capacity_{0}, resource_{allocator.resource()} {
+}
+
+String::String(std::size_t size, char symbol, const allocator_type& allocator) : resource_{allocator.resource()} {
   if (size == 0) {
     string_ = nullptr;
     size_ = 0;
     capacity_ = 0;
   } else {
-    string_ = new char[size + 1];
+    string_ = Allocate(size);
     size_ = size;
     capacity_ = size;
     for (std::size_t i = 0; i != size; ++i) {
@@ -19,9 +25,9 @@ String::String(std::size_t size, char symbol) {
   }
 }
 
-String::String(const char* cstyle) {
+String::String(const char* cstyle, const allocator_type& allocator) : resource_{allocator.resource()} {
   std::size_t size = Strlen(cstyle);
-  string_ = new char[size + 1];
+  string_ = Allocate(size);
   size_ = size;
   capacity_ = size;
   for (std::size_t i = 0; i != size; ++i) {
@@ -30,21 +36,26 @@ String::String(const char* cstyle) {
   string_[size] = '\0';
 }
 
-String::String(const char* cstyle, std::size_t size) : string_{new char[size + 1]}, size_{size}, capacity_{size} {
+String::String(const char* cstyle, std::size_t size, const allocator_type& allocator)
+    : size_{size}, capacity_{size}, resource_{allocator.resource()} {
+  string_ = Allocate(size);
   for (std::size_t i = 0; i != size; ++i) {
     string_[i] = cstyle[i];
   }
   string_[size] = '\0';
 }
 
-String::String(const String& copy) {
+String::String(const String& copy) : String(copy, allocator_type()) {
+}
+
+String::String(const String& copy, const allocator_type& allocator) : resource_{allocator.resource()} {
   if (copy.string_ == nullptr) {
     string_ = nullptr;
     size_ = 0;
     capacity_ = 0;
   } else {
     std::size_t size = copy.size_;
-    string_ = new char[size + 1];
+    string_ = Allocate(size);
     size_ = size;
     capacity_ = size;
     for (std::size_t i = 0; i != size; ++i) {
@@ -58,26 +69,70 @@ String& String::operator=(const String& copy) {
   if (this == &copy) {
     return *this;
   }
-  delete[] string_;
-  string_ = nullptr;
-  size_ = copy.size_;
-  capacity_ = copy.capacity_;
-  if (size_) {
-    string_ = new char[size_ + 1];
+  if (capacity_ < copy.size_ || string_ == nullptr) {
+    Deallocate(string_, capacity_);
+    string_ = nullptr;
+    capacity_ = 0;
+    string_ = Allocate(copy.size_);
+    capacity_ = copy.size_;
   }
+  size_ = copy.size_;
   for (std::size_t i = 0; i != size_; ++i) {
     string_[i] = copy.string_[i];
   }
+  string_[size_] = '\0';
+  return *this;
+}
+
+String::String(String&& other) noexcept
+    : string_{other.string_}, size_{other.size_}, capacity_{other.capacity_}, resource_{other.resource_} {
+  other.string_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+}
+
+String::String(String&& other, const allocator_type& allocator) : String(allocator) {
+  if (resource_ == other.resource_ || resource_->is_equal(*other.resource_)) {
+    Swap(other);
+  } else {
+    *this = static_cast<const String&>(other);
+  }
+}
+
+String& String::operator=(String&& other) {
+  if (this == &other) {
+    return *this;
+  }
+  if (resource_ != other.resource_ && !resource_->is_equal(*other.resource_)) {
+    return *this = static_cast<const String&>(other);
+  }
+  Deallocate(string_, capacity_);
+  string_ = other.string_;
+  size_ = other.size_;
+  capacity_ = other.capacity_;
+  other.string_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
   return *this;
 }
 
 String::~String() {
-  delete[] string_;
+  Deallocate(string_, capacity_);
   string_ = nullptr;
   size_ = 0;
   capacity_ = 0;
 }
 
+char* String::Allocate(std::size_t capacity) {
+  return static_cast<char*>(resource_->allocate(capacity + 1, alignof(char)));
+}
+
+void String::Deallocate(char* string, std::size_t capacity) {
+  if (string != nullptr) {
+    resource_->deallocate(string, capacity + 1, alignof(char));
+  }
+}
+
 const char& String::operator[](std::size_t index) const {
   return string_[index];
 }
@@ -128,6 +183,10 @@ const char* String::Data() const {
   return string_;
 }
 
+String::operator StringView() const {
+  return {string_, size_};
+}
+
 bool String::Empty() const {
   return size_ == 0;
 }
@@ -151,10 +210,19 @@ void String::Clear() {
   }
 }
 
+std::pmr::memory_resource* String::Resource() const {
+  return resource_;
+}
+
+String::allocator_type String::GetAllocator() const {
+  return resource_;
+}
+
 void String::Swap(String& other) {
-  String temp = *this;
-  *this = other;
-  other = temp;
+  std::swap(string_, other.string_);
+  std::swap(size_, other.size_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(resource_, other.resource_);
 }
 
 void String::PopBack() {
@@ -198,6 +266,30 @@ String& String::operator+=(const String& other) {
   return *this;
 }
 
+void String::ReserveForAppend(std::size_t extra) {
+  if (size_ + extra > capacity_) {
+    Reserve(size_ + extra < capacity_ * 2 ? capacity_ * 2 : size_ + extra);
+  }
+}
+
+String& String::AppendInt(int64_t value) {
+  constexpr std::size_t kMaxIntLength = 20;
+  ReserveForAppend(kMaxIntLength);
+  auto result = std::to_chars(string_ + size_, string_ + capacity_, value);
+  size_ = result.ptr - string_;
+  string_[size_] = '\0';
+  return *this;
+}
+
+String& String::AppendDouble(double value) {
+  constexpr std::size_t kMaxDoubleLength = 24;
+  ReserveForAppend(kMaxDoubleLength);
+  auto result = std::to_chars(string_ + size_, string_ + capacity_, value);
+  size_ = result.ptr - string_;
+  string_[size_] = '\0';
+  return *this;
+}
+
 void String::Resize(std::size_t new_size, char symbol) {
   if (new_size == 0 && size_ == 0) {
     return;
@@ -223,12 +315,12 @@ void String::Resize(std::size_t new_size, char symbol) {
 
 void String::Reserve(std::size_t new_capacity) {
   if (new_capacity > capacity_) {
-    auto temp = new char[new_capacity + 1];
+    auto temp = Allocate(new_capacity);
     for (std::size_t i = 0; i != size_; ++i) {
       temp[i] = string_[i];
     }
     temp[size_] = '\0';
-    delete[] string_;
+    Deallocate(string_, capacity_);
     string_ = temp;
     capacity_ = new_capacity;
   }
@@ -239,37 +331,69 @@ void String::ShrinkToFit() {
     capacity_ = 0;
   }
   if (size_ < capacity_) {
-    auto temp = new char[size_ + 1];
+    auto temp = Allocate(size_);
     for (std::size_t i = 0; i != size_; ++i) {
       temp[i] = string_[i];
     }
     temp[size_] = '\0';
-    delete[] string_;
+    Deallocate(string_, capacity_);
     string_ = temp;
     capacity_ = size_;
   }
 }
 
+void String::ToLowerAscii() {
+  AsciiToLower(string_, size_, string_);
+}
+
+void String::ToUpperAscii() {
+  AsciiToUpper(string_, size_, string_);
+}
+
+String String::ToLowerAsciiCopy() const {
+  String res{resource_};
+  if (size_ == 0) {
+    return res;
+  }
+  res.Reserve(size_);
+  AsciiToLower(string_, size_, res.string_);
+  res.size_ = size_;
+  res.string_[size_] = '\0';
+  return res;
+}
+
+String String::ToUpperAsciiCopy() const {
+  String res{resource_};
+  if (size_ == 0) {
+    return res;
+  }
+  res.Reserve(size_);
+  AsciiToUpper(string_, size_, res.string_);
+  res.size_ = size_;
+  res.string_[size_] = '\0';
+  return res;
+}
+
 String String::operator+(const String& other) const {
-  auto temp = new char[size_ + other.size_ + 1];
+  String res{resource_};
+  res.Reserve(size_ + other.size_);
   for (std::size_t i = 0; i != size_; ++i) {
-    temp[i] = string_[i];
+    res.string_[i] = string_[i];
   }
   for (std::size_t i = 0; i != other.size_; ++i) {
-    temp[i + size_] = other.string_[i];
+    res.string_[i + size_] = other.string_[i];
   }
-  temp[size_ + other.size_] = '\0';
-  String res{temp};
-  delete[] temp;
+  res.size_ = size_ + other.size_;
+  res.string_[res.size_] = '\0';
   return res;
 }
 
 String String::operator+(const char* str) const {
-  return *this + String(str);
+  return *this + String(str, resource_);
 }
 
 String operator+(const char* str, const String& string) {
-  return String(str) + string;
+  return String(str, string.resource_) + string;
 }
 
 bool String::operator==(const String& other) const {
@@ -1,9 +1,13 @@
 #ifndef CPPSTRING_H
 #define CPPSTRING_H
 
+#include <cstdint>
 #include <iostream>
+#include <memory_resource>
 #include <stdexcept>
 
+#include "../string_view/string_view.h"
+
 class StringOutOfRange : public std::out_of_range {
  public:
   StringOutOfRange() : std::out_of_range("StringOutOfRange") {
@@ -15,15 +19,32 @@ class String {
   char* string_{};
   std::size_t size_{};
   std::size_t capacity_{};
+  std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+
+  char* Allocate(std::size_t);
+  void Deallocate(char*, std::size_t);
+  void ReserveForAppend(std::size_t);
 
  public:
+  // Containers that construct elements through a polymorphic allocator, such as Vector with
+  // std::pmr::polymorphic_allocator, pass their memory resource on to the strings they hold. A memory_resource*
+  // converts to the allocator, so either can be given.
+  using allocator_type = std::pmr::polymorphic_allocator<char>;  // NOLINT
+
   String();
-  String(std::size_t, char);
-  String(const char*);  // NOLINT
-  String(const char*, std::size_t);
+  explicit String(const allocator_type&);
+  String(std::size_t, char, const allocator_type& = {});
+  String(const char*, const allocator_type& = {});  // NOLINT
+  String(const char*, std::size_t, const allocator_type& = {});
 
+  // As for the standard containers, a copy uses the default resource and a move keeps the source's resource
+  // unless another one is given.
   String(const String&);
+  String(const String&, const allocator_type&);
   String& operator=(const String&);
+  String(String&&) noexcept;
+  String(String&&, const allocator_type&);
+  String& operator=(String&&);
   ~String();
 
   const char& operator[](std::size_t) const;
@@ -40,11 +61,15 @@ class String {
   char* CStr();
   [[nodiscard]] const char* Data() const;
 
+  operator StringView() const;  // NOLINT
+
   [[nodiscard]] bool Empty() const;
 
   [[nodiscard]] std::size_t Size() const;
   [[nodiscard]] std::size_t Length() const;
   [[nodiscard]] std::size_t Capacity() const;
+  [[nodiscard]] std::pmr::memory_resource* Resource() const;
+  [[nodiscard]] allocator_type GetAllocator() const;
 
   void Clear();
   void Swap(String&);
@@ -52,10 +77,18 @@ class String {
   void PushBack(char);
 
   String& operator+=(const String&);
+  String& AppendInt(int64_t);
+  String& AppendDouble(double);
   void Resize(std::size_t, char);
 
   void Reserve(std::size_t);
   void ShrinkToFit();
+
+  void ToLowerAscii();
+  void ToUpperAscii();
+  [[nodiscard]] String ToLowerAsciiCopy() const;
+  [[nodiscard]] String ToUpperAsciiCopy() const;
+
   String operator+(const String&) const;
   String operator+(const char*) const;
   friend String operator+(const char*, const String&);
@@ -0,0 +1,180 @@
+#include "epoch.h"
+
+namespace {
+
+std::atomic<uint64_t> next_domain_id{1};
+
+// The record the current thread used last, so an outer Guard normally reacquires the same uncontended slot and
+// nested Guards on the same domain skip the CAS entirely. Keyed by domain id rather than address, so a stale
+// entry left behind by a destroyed domain is never dereferenced.
+struct LocalRecord {
+  uint64_t domain_id = 0;
+  void* record = nullptr;
+  int depth = 0;
+};
+
+thread_local LocalRecord local_record;
+
+constexpr uint64_t kPinned = 1;
+
+}  // namespace
+
+EpochDomain::EpochDomain() : id_{next_domain_id.fetch_add(1, std::memory_order_relaxed)} {
+}
+
+EpochDomain::~EpochDomain() {
+  Record* record = records_.load(std::memory_order_acquire);
+  while (record) {
+    Retired* retired = record->retired_head_;
+    while (retired) {
+      Retired* next = retired->next;
+      delete retired;
+      retired = next;
+    }
+    Record* next = record->next_;
+    delete record;
+    record = next;
+  }
+}
+
+EpochDomain& EpochDomain::Default() {
+  static auto* domain = new EpochDomain();
+  return *domain;
+}
+
+EpochDomain::Record* EpochDomain::AcquireRecord() {
+  for (Record* record = records_.load(std::memory_order_acquire); record; record = record->next_) {
+    if (!record->in_use_.load(std::memory_order_relaxed) && record->TryAcquire()) {
+      return record;
+    }
+  }
+  auto* record = new Record();
+  Record* head = records_.load(std::memory_order_relaxed);
+  do {
+    record->next_ = head;
+  } while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+  return record;
+}
+
+void EpochDomain::Pin(Record* record) {
+  uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+  while (true) {
+    record->announced_.store(epoch << 1 | kPinned, std::memory_order_seq_cst);
+    const uint64_t current = epoch_.load(std::memory_order_seq_cst);
+    if (current == epoch) {
+      return;
+    }
+    epoch = current;
+  }
+}
+
+void EpochDomain::Unpin(Record* record) {
+  record->announced_.store(record->announced_.load(std::memory_order_relaxed) & ~kPinned,
+                           std::memory_order_release);
+}
+
+void EpochDomain::Push(Record* record, Retired* retired) {
+  retired->epoch = epoch_.load(std::memory_order_seq_cst);
+  if (record->retired_tail_) {
+    record->retired_tail_->next = retired;
+  } else {
+    record->retired_head_ = retired;
+  }
+  record->retired_tail_ = retired;
+  record->pending_.store(record->pending_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// The epoch moves forward only when every pinned record has announced the current one. An object retired in
+// epoch e can therefore be seen only by Guards pinned in e or earlier, all of which are gone by epoch e + 2.
+bool EpochDomain::TryAdvance() {
+  uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+  for (Record* record = records_.load(std::memory_order_acquire); record; record = record->next_) {
+    const uint64_t announced = record->announced_.load(std::memory_order_seq_cst);
+    if ((announced & kPinned) && (announced >> 1) != epoch) {
+      return false;
+    }
+  }
+  return epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+void EpochDomain::Reclaim(Record* record) {
+  const uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+  // Detach the expired prefix first: deleters may retire further objects into other records.
+  Retired* head = record->retired_head_;
+  Retired* last = nullptr;
+  std::size_t count = 0;
+  for (Retired* retired = head; retired && retired->epoch + 2 <= epoch; retired = retired->next) {
+    last = retired;
+    ++count;
+  }
+  if (last == nullptr) {
+    return;
+  }
+  record->retired_head_ = last->next;
+  if (record->retired_head_ == nullptr) {
+    record->retired_tail_ = nullptr;
+  }
+  last->next = nullptr;
+  record->pending_.store(record->pending_.load(std::memory_order_relaxed) - count, std::memory_order_relaxed);
+  while (head) {
+    Retired* next = head->next;
+    delete head;
+    head = next;
+  }
+}
+
+void EpochDomain::Collect() {
+  TryAdvance();
+  TryAdvance();
+  for (Record* record = records_.load(std::memory_order_acquire); record; record = record->next_) {
+    if (record->pending_.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    if (!record->in_use_.load(std::memory_order_relaxed) && record->TryAcquire()) {
+      Reclaim(record);
+      record->Release();
+    }
+  }
+}
+
+std::size_t EpochDomain::PendingCount() const {
+  std::size_t count = 0;
+  for (Record* record = records_.load(std::memory_order_acquire); record; record = record->next_) {
+    count += record->pending_.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+EpochDomain::Guard::Guard(EpochDomain& domain) : domain_{domain}, record_{nullptr}, cached_{false} {
+  LocalRecord& local = local_record;
+  if (local.domain_id == domain_.id_ && local.depth > 0) {
+    record_ = static_cast<Record*>(local.record);
+    cached_ = true;
+    ++local.depth;
+    return;
+  }
+  if (local.depth == 0) {
+    if (local.domain_id == domain_.id_ && static_cast<Record*>(local.record)->TryAcquire()) {
+      record_ = static_cast<Record*>(local.record);
+    } else {
+      record_ = domain_.AcquireRecord();
+    }
+    local = {domain_.id_, record_, 1};
+    cached_ = true;
+  } else {
+    record_ = domain_.AcquireRecord();
+  }
+  domain_.Pin(record_);
+}
+
+EpochDomain::Guard::~Guard() {
+  if (cached_ && --local_record.depth > 0) {
+    return;
+  }
+  domain_.Unpin(record_);
+  if (record_->pending_.load(std::memory_order_relaxed) >= kCollectThreshold) {
+    domain_.TryAdvance();
+    domain_.Reclaim(record_);
+  }
+  record_->Release();
+}
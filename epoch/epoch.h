@@ -0,0 +1,144 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "../shared_ptr/shared_ptr.h"
+
+// Epoch-based reclamation. Readers pin the domain with a Guard and may then dereference shared nodes with plain
+// loads; writers unlink a node and Retire it, and the domain runs its deleter only after every Guard that could
+// still see the node has been released. A Guard costs one uncontended CAS on a per-thread record plus a store
+// of the current epoch, independent of how many nodes the traversal touches.
+class EpochDomain {
+ private:
+  struct Retired {
+    Retired* next = nullptr;
+    uint64_t epoch = 0;
+
+    virtual ~Retired() = default;
+  };
+
+  template <typename T, typename Deleter>
+  struct RetiredPointer : Retired {
+    T* ptr_;
+    [[no_unique_address]] Deleter deleter_;
+
+    RetiredPointer(T* ptr, Deleter deleter) : ptr_{ptr}, deleter_{std::move(deleter)} {
+    }
+
+    ~RetiredPointer() override {
+      deleter_(ptr_);
+    }
+  };
+
+  template <typename T, typename RefCount>
+  struct RetiredShared : Retired {
+    SharedPtr<T, RefCount> ptr_;
+
+    explicit RetiredShared(SharedPtr<T, RefCount>&& ptr) : ptr_{std::move(ptr)} {
+    }
+  };
+
+  // Participant slot. A thread owns a record while in_use_ is set; only the owner touches the retired list.
+  // Records are never freed before the domain, so readers of the record list need no protection.
+  struct alignas(64) Record {
+    std::atomic<uint64_t> announced_{0};  // epoch << 1 | pinned
+    std::atomic<bool> in_use_{true};
+    std::atomic<std::size_t> pending_{0};
+    Retired* retired_head_ = nullptr;
+    Retired* retired_tail_ = nullptr;
+    Record* next_ = nullptr;
+
+    bool TryAcquire() {
+      bool expected = false;
+      return in_use_.compare_exchange_strong(expected, true, std::memory_order_acquire);
+    }
+
+    void Release() {
+      in_use_.store(false, std::memory_order_release);
+    }
+  };
+
+  static constexpr std::size_t kCollectThreshold = 64;
+
+  const uint64_t id_;
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<Record*> records_{nullptr};
+
+  Record* AcquireRecord();
+  void Pin(Record* record);
+  void Unpin(Record* record);
+  void Push(Record* record, Retired* retired);
+  bool TryAdvance();
+  void Reclaim(Record* record);
+
+ public:
+  class Guard {
+   private:
+    EpochDomain& domain_;
+    Record* record_;
+    bool cached_;
+
+   public:
+    explicit Guard(EpochDomain& domain);
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    ~Guard();
+
+    template <typename T, typename Deleter>
+    void Retire(T* ptr, Deleter deleter) {
+      domain_.Push(record_, new RetiredPointer<T, Deleter>(ptr, std::move(deleter)));
+    }
+
+    template <typename T>
+    void Retire(T* ptr) {
+      Retire(ptr, [](T* retired) { delete retired; });
+    }
+
+    // Keeps the object alive for a grace period: the reference is dropped once no Guard active now remains.
+    template <typename T, typename RefCount>
+    void Retire(SharedPtr<T, RefCount> ptr) {
+      domain_.Push(record_, new RetiredShared<T, RefCount>(std::move(ptr)));
+    }
+  };
+
+  EpochDomain();
+
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  // Runs every pending deleter. No Guard may be active.
+  ~EpochDomain();
+
+  // Process-wide domain; never destroyed.
+  static EpochDomain& Default();
+
+  template <typename T, typename Deleter>
+  void Retire(T* ptr, Deleter deleter) {
+    Guard(*this).Retire(ptr, std::move(deleter));
+  }
+
+  template <typename T>
+  void Retire(T* ptr) {
+    Guard(*this).Retire(ptr);
+  }
+
+  template <typename T, typename RefCount>
+  void Retire(SharedPtr<T, RefCount> ptr) {
+    Guard(*this).Retire(std::move(ptr));
+  }
+
+  // Tries to advance the epoch and reclaims whatever has become safe in records that are not in use. When no
+  // Guard is active, every object retired before the call has been reclaimed when it returns.
+  void Collect();
+
+  // Number of retired objects still waiting for their grace period.
+  std::size_t PendingCount() const;
+};
+
+#endif
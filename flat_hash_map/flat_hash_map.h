@@ -0,0 +1,414 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../cppstring/cppstring.h"
+#include "../string_view/string_view.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Open-addressing map from String keys in the style of Swiss tables. Every slot has one control byte: the low
+// seven bits of the key hash when full, or a negative empty/deleted marker. A probe compares a whole group of
+// sixteen control bytes against the hash at once and only touches slots whose byte matches. Lookups accept any
+// StringView, so probing never constructs a String.
+template <typename T, typename Hash = StringViewHash, typename KeyEqual = std::equal_to<StringView>>
+class FlatStringMap {
+ public:
+  struct Entry {
+    String key;
+    T value;
+  };
+
+ private:
+  static constexpr std::size_t kGroupWidth = 16;
+  static constexpr int8_t kEmpty = -128;
+  static constexpr int8_t kDeleted = -2;
+
+  // The first kGroupWidth - 1 control bytes are mirrored after the end, so a group can be loaded at any slot.
+  int8_t* control_{};
+  Entry* slots_{};
+  std::size_t capacity_{};
+  std::size_t size_{};
+  std::size_t deleted_{};
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] KeyEqual key_equal_;
+
+  static uint32_t MatchByte(const int8_t* group, int8_t byte) {
+#if defined(__SSE2__)
+    const __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(byte)));
+#else
+    uint32_t mask = 0;
+    for (std::size_t i = 0; i != kGroupWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+  }
+
+  static uint32_t MatchEmptyOrDeleted(const int8_t* group) {
+#if defined(__SSE2__)
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+    uint32_t mask = 0;
+    for (std::size_t i = 0; i != kGroupWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+  }
+
+  static int8_t ShortHash(std::size_t hash) {
+    return static_cast<int8_t>(hash & 0x7F);
+  }
+
+  void SetControl(std::size_t index, int8_t value) {
+    control_[index] = value;
+    if (index < kGroupWidth - 1) {
+      control_[capacity_ + index] = value;
+    }
+  }
+
+  // Index of the slot holding key, or capacity_ if there is none.
+  std::size_t FindIndex(StringView key, std::size_t hash) const {
+    if (capacity_ == 0) {
+      return capacity_;
+    }
+    const std::size_t mask = capacity_ - 1;
+    const int8_t short_hash = ShortHash(hash);
+    std::size_t position = (hash >> 7) & mask;
+    for (std::size_t step = kGroupWidth;; step += kGroupWidth) {
+      const int8_t* group = control_ + position;
+      for (uint32_t match = MatchByte(group, short_hash); match != 0; match &= match - 1) {
+        const std::size_t index = (position + __builtin_ctz(match)) & mask;
+        if (key_equal_(StringView(slots_[index].key), key)) {
+          return index;
+        }
+      }
+      if (MatchByte(group, kEmpty) != 0) {
+        return capacity_;
+      }
+      position = (position + step) & mask;
+    }
+  }
+
+  std::size_t FindInsertIndex(std::size_t hash) const {
+    const std::size_t mask = capacity_ - 1;
+    std::size_t position = (hash >> 7) & mask;
+    for (std::size_t step = kGroupWidth;; step += kGroupWidth) {
+      const uint32_t match = MatchEmptyOrDeleted(control_ + position);
+      if (match != 0) {
+        return (position + __builtin_ctz(match)) & mask;
+      }
+      position = (position + step) & mask;
+    }
+  }
+
+  void Rehash(std::size_t new_capacity) {
+    FlatStringMap other;
+    other.hash_ = hash_;
+    other.key_equal_ = key_equal_;
+    other.Allocate(new_capacity);
+    for (std::size_t i = 0; i != capacity_; ++i) {
+      if (control_[i] >= 0) {
+        const std::size_t hash = hash_(StringView(slots_[i].key));
+        const std::size_t index = other.FindInsertIndex(hash);
+        new (other.slots_ + index) Entry{std::move(slots_[i].key), std::move(slots_[i].value)};
+        other.SetControl(index, ShortHash(hash));
+        ++other.size_;
+      }
+    }
+    Swap(other);
+  }
+
+  void Allocate(std::size_t capacity) {
+    control_ = new int8_t[capacity + kGroupWidth - 1];
+    std::memset(control_, kEmpty, capacity + kGroupWidth - 1);
+    slots_ = static_cast<Entry*>(operator new(sizeof(Entry) * capacity));
+    capacity_ = capacity;
+  }
+
+  void Destroy() {
+    for (std::size_t i = 0; i != capacity_; ++i) {
+      if (control_[i] >= 0) {
+        std::destroy_at(slots_ + i);
+      }
+    }
+    delete[] control_;
+    operator delete(slots_);
+    control_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    deleted_ = 0;
+  }
+
+  static std::size_t MaxLoad(std::size_t capacity) {
+    return capacity - capacity / 8;
+  }
+
+  void PrepareInsert() {
+    if (capacity_ == 0) {
+      Allocate(kGroupWidth);
+    } else if (size_ + deleted_ + 1 > MaxLoad(capacity_)) {
+      Rehash(size_ + 1 > MaxLoad(capacity_) / 2 ? capacity_ * 2 : capacity_);
+    }
+  }
+
+  template <typename K>
+  static String MakeKey(K&& key) {
+    if constexpr (std::is_same_v<std::decay_t<K>, String>) {
+      return String(std::forward<K>(key));
+    } else {
+      const StringView view(key);
+      return String(view.Data(), view.Size());
+    }
+  }
+
+  template <typename Pointer>
+  class BasicIterator {
+   private:
+    const int8_t* control_{};
+    Pointer slot_{};
+    Pointer end_{};
+
+    void SkipEmpty() {
+      while (slot_ != end_ && *control_ < 0) {
+        ++control_;
+        ++slot_;
+      }
+    }
+
+   public:
+    using difference_type = std::ptrdiff_t;                                      // NOLINT
+    using value_type = Entry;                                                    // NOLINT
+    using pointer = Pointer;                                                     // NOLINT
+    using reference = std::remove_pointer_t<Pointer>&;                           // NOLINT
+    using iterator_category = std::forward_iterator_tag;                         // NOLINT
+
+    BasicIterator() = default;
+
+    BasicIterator(const int8_t* control, Pointer slot, Pointer end) : control_{control}, slot_{slot}, end_{end} {
+      SkipEmpty();
+    }
+
+    reference operator*() const {
+      return *slot_;
+    }
+
+    pointer operator->() const {
+      return slot_;
+    }
+
+    BasicIterator& operator++() {
+      ++control_;
+      ++slot_;
+      SkipEmpty();
+      return *this;
+    }
+
+    BasicIterator operator++(int) {
+      auto temp = *this;
+      ++*this;
+      return temp;
+    }
+
+    friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) {
+      return lhs.slot_ == rhs.slot_;
+    }
+
+    friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) {
+      return !(lhs == rhs);
+    }
+  };
+
+ public:
+  using Iterator = BasicIterator<Entry*>;
+  using ConstIterator = BasicIterator<const Entry*>;
+
+  FlatStringMap() = default;
+
+  explicit FlatStringMap(std::size_t size) {
+    Reserve(size);
+  }
+
+  FlatStringMap(const FlatStringMap& other) : hash_{other.hash_}, key_equal_{other.key_equal_} {
+    Reserve(other.size_);
+    for (const auto& entry : other) {
+      TryEmplace(entry.key, entry.value);
+    }
+  }
+
+  FlatStringMap& operator=(const FlatStringMap& other) {
+    if (this != &other) {
+      FlatStringMap(other).Swap(*this);
+    }
+    return *this;
+  }
+
+  FlatStringMap(FlatStringMap&& other) noexcept
+      : control_{other.control_},
+        slots_{other.slots_},
+        capacity_{other.capacity_},
+        size_{other.size_},
+        deleted_{other.deleted_},
+        hash_{std::move(other.hash_)},
+        key_equal_{std::move(other.key_equal_)} {
+    other.control_ = nullptr;
+    other.slots_ = nullptr;
+    other.capacity_ = 0;
+    other.size_ = 0;
+    other.deleted_ = 0;
+  }
+
+  FlatStringMap& operator=(FlatStringMap&& other) noexcept {
+    if (this != &other) {
+      Destroy();
+      FlatStringMap(std::move(other)).Swap(*this);
+    }
+    return *this;
+  }
+
+  ~FlatStringMap() {
+    Destroy();
+  }
+
+  std::size_t Size() const {
+    return size_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  std::size_t Capacity() const {
+    return capacity_;
+  }
+
+  void Reserve(std::size_t size) {
+    std::size_t capacity = kGroupWidth;
+    while (MaxLoad(capacity) < size) {
+      capacity *= 2;
+    }
+    if (capacity > capacity_) {
+      if (capacity_ == 0) {
+        Allocate(capacity);
+      } else {
+        Rehash(capacity);
+      }
+    }
+  }
+
+  void Clear() {
+    for (std::size_t i = 0; i != capacity_; ++i) {
+      if (control_[i] >= 0) {
+        std::destroy_at(slots_ + i);
+      }
+    }
+    if (capacity_ != 0) {
+      std::memset(control_, kEmpty, capacity_ + kGroupWidth - 1);
+    }
+    size_ = 0;
+    deleted_ = 0;
+  }
+
+  void Swap(FlatStringMap& other) {
+    std::swap(control_, other.control_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(deleted_, other.deleted_);
+    std::swap(hash_, other.hash_);
+    std::swap(key_equal_, other.key_equal_);
+  }
+
+  T* Find(StringView key) {
+    const std::size_t index = FindIndex(key, hash_(key));
+    return index == capacity_ ? nullptr : &slots_[index].value;
+  }
+
+  const T* Find(StringView key) const {
+    const std::size_t index = FindIndex(key, hash_(key));
+    return index == capacity_ ? nullptr : &slots_[index].value;
+  }
+
+  bool Contains(StringView key) const {
+    return FindIndex(key, hash_(key)) != capacity_;
+  }
+
+  // Constructs the value from args only if key is absent; the key is converted to String only in that case.
+  // Returns the stored value and whether it was inserted.
+  template <typename K, typename... Args>
+  std::pair<T*, bool> TryEmplace(K&& key, Args&&... args) {
+    const StringView view(key);
+    const std::size_t hash = hash_(view);
+    std::size_t index = FindIndex(view, hash);
+    if (index != capacity_) {
+      return {&slots_[index].value, false};
+    }
+    String new_key = MakeKey(std::forward<K>(key));
+    PrepareInsert();
+    index = FindInsertIndex(hash);
+    new (slots_ + index) Entry{std::move(new_key), T(std::forward<Args>(args)...)};
+    if (control_[index] == kDeleted) {
+      --deleted_;
+    }
+    SetControl(index, ShortHash(hash));
+    ++size_;
+    return {&slots_[index].value, true};
+  }
+
+  template <typename K, typename V>
+  std::pair<T*, bool> InsertOrAssign(K&& key, V&& value) {
+    auto result = TryEmplace(std::forward<K>(key), std::forward<V>(value));
+    if (!result.second) {
+      *result.first = std::forward<V>(value);
+    }
+    return result;
+  }
+
+  T& operator[](StringView key) {
+    return *TryEmplace(key).first;
+  }
+
+  bool Erase(StringView key) {
+    const std::size_t index = FindIndex(key, hash_(key));
+    if (index == capacity_) {
+      return false;
+    }
+    std::destroy_at(slots_ + index);
+    SetControl(index, kDeleted);
+    --size_;
+    ++deleted_;
+    return true;
+  }
+
+  Iterator begin() {  // NOLINT
+    return {control_, slots_, slots_ + capacity_};
+  }
+
+  Iterator end() {  // NOLINT
+    return {control_ + capacity_, slots_ + capacity_, slots_ + capacity_};
+  }
+
+  ConstIterator begin() const {  // NOLINT
+    return {control_, slots_, slots_ + capacity_};
+  }
+
+  ConstIterator end() const {  // NOLINT
+    return {control_ + capacity_, slots_ + capacity_, slots_ + capacity_};
+  }
+};
+
+#endif
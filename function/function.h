@@ -0,0 +1,276 @@
+#ifndef FUNCTION_H
+#define FUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+class BadFunctionCall : public std::runtime_error {
+ public:
+  BadFunctionCall() : std::runtime_error("BadFunctionCall") {
+  }
+};
+
+inline constexpr std::size_t kDefaultFunctionBuffer = 3 * sizeof(void*);
+
+// Shared implementation of Function and UniqueFunction. Like Any, a callable that fits the buffer and is
+// nothrow-movable lives inline and anything else on the heap, with a static table of lifetime functions per
+// type. The call itself goes through a plain function pointer stored in the object, so invoking costs one
+// indirect call and no table lookup; an empty object points it at a function that throws BadFunctionCall.
+template <bool kCopyable, std::size_t BufferSize, typename R, typename... Args>
+class BasicFunction {
+ private:
+  static_assert(BufferSize >= sizeof(void*), "the buffer must be able to hold a pointer");
+
+  union Storage {
+    alignas(void*) unsigned char buffer[BufferSize];
+    void* heap;
+  };
+
+  using Invoke = R (*)(Storage& storage, Args&&... args);
+
+  struct Ops {
+    void (*destroy)(Storage& storage) noexcept;
+    void (*copy)(const Storage& from, Storage& to);
+    // Moves the callable and leaves from without one.
+    void (*move)(Storage& from, Storage& to) noexcept;
+  };
+
+  template <typename F>
+  static constexpr bool kFitsInline = sizeof(F) <= BufferSize && alignof(void*) % alignof(F) == 0 &&
+                                      std::is_nothrow_move_constructible_v<F>;
+
+  template <typename F>
+  struct InlineOps {
+    static F* Get(Storage& storage) noexcept {
+      return std::launder(reinterpret_cast<F*>(storage.buffer));
+    }
+
+    static R Call(Storage& storage, Args&&... args) {
+      if constexpr (std::is_void_v<R>) {
+        std::invoke(*Get(storage), std::forward<Args>(args)...);
+      } else {
+        return std::invoke(*Get(storage), std::forward<Args>(args)...);
+      }
+    }
+
+    static void Destroy(Storage& storage) noexcept {
+      Get(storage)->~F();
+    }
+
+    static void Copy(const Storage& from, Storage& to) {
+      if constexpr (kCopyable) {
+        new (to.buffer) F(*Get(const_cast<Storage&>(from)));
+      }
+    }
+
+    static void Move(Storage& from, Storage& to) noexcept {
+      new (to.buffer) F(std::move(*Get(from)));
+      Destroy(from);
+    }
+
+    static constexpr Ops kOps{&Destroy, kCopyable ? &Copy : nullptr, &Move};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F* Get(Storage& storage) noexcept {
+      return static_cast<F*>(storage.heap);
+    }
+
+    static R Call(Storage& storage, Args&&... args) {
+      if constexpr (std::is_void_v<R>) {
+        std::invoke(*Get(storage), std::forward<Args>(args)...);
+      } else {
+        return std::invoke(*Get(storage), std::forward<Args>(args)...);
+      }
+    }
+
+    static void Destroy(Storage& storage) noexcept {
+      delete Get(storage);
+    }
+
+    static void Copy(const Storage& from, Storage& to) {
+      if constexpr (kCopyable) {
+        to.heap = new F(*static_cast<const F*>(from.heap));
+      }
+    }
+
+    static void Move(Storage& from, Storage& to) noexcept {
+      to.heap = from.heap;
+      from.heap = nullptr;
+    }
+
+    static constexpr Ops kOps{&Destroy, kCopyable ? &Copy : nullptr, &Move};
+  };
+
+  template <typename F>
+  using OpsFor = std::conditional_t<kFitsInline<F>, InlineOps<F>, HeapOps<F>>;
+
+  static R ThrowBadCall(Storage&, Args&&...) {
+    throw BadFunctionCall{};
+  }
+
+  mutable Storage storage_;
+  Invoke invoke_ = &ThrowBadCall;
+  const Ops* ops_ = nullptr;
+
+  void MoveFrom(BasicFunction& other) noexcept {
+    if (other.ops_) {
+      other.ops_->move(other.storage_, storage_);
+      invoke_ = other.invoke_;
+      ops_ = other.ops_;
+      other.invoke_ = &ThrowBadCall;
+      other.ops_ = nullptr;
+    }
+  }
+
+ protected:
+  template <typename F>
+  using EnableIfCallable =
+      std::enable_if_t<!std::is_base_of_v<BasicFunction, std::decay_t<F>> &&
+                       std::is_invocable_r_v<R, std::decay_t<F>&, Args...> &&
+                       (!kCopyable || std::is_copy_constructible_v<std::decay_t<F>>)>;
+
+  BasicFunction() = default;
+
+  BasicFunction(std::nullptr_t) {  // NOLINT
+  }
+
+  template <typename F>
+  explicit BasicFunction(F&& callable) {
+    using Callable = std::decay_t<F>;
+    if constexpr (std::is_pointer_v<Callable> || std::is_member_pointer_v<Callable>) {
+      if (callable == nullptr) {
+        return;
+      }
+    }
+    if constexpr (kFitsInline<Callable>) {
+      new (storage_.buffer) Callable(std::forward<F>(callable));
+    } else {
+      storage_.heap = new Callable(std::forward<F>(callable));
+    }
+    invoke_ = &OpsFor<Callable>::Call;
+    ops_ = &OpsFor<Callable>::kOps;
+  }
+
+  BasicFunction(const BasicFunction& other) {
+    static_assert(kCopyable);
+    if (other.ops_) {
+      other.ops_->copy(other.storage_, storage_);
+      invoke_ = other.invoke_;
+      ops_ = other.ops_;
+    }
+  }
+
+  BasicFunction(BasicFunction&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  BasicFunction& operator=(const BasicFunction& other) {
+    if (this != &other) {
+      BasicFunction temp(other);
+      Reset();
+      MoveFrom(temp);
+    }
+    return *this;
+  }
+
+  BasicFunction& operator=(BasicFunction&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~BasicFunction() {
+    Reset();
+  }
+
+ public:
+  R operator()(Args... args) const {
+    return invoke_(storage_, std::forward<Args>(args)...);
+  }
+
+  void Reset() noexcept {
+    if (ops_) {
+      ops_->destroy(storage_);
+      invoke_ = &ThrowBadCall;
+      ops_ = nullptr;
+    }
+  }
+
+  void Swap(BasicFunction& other) noexcept {
+    BasicFunction temp(std::move(other));
+    other.MoveFrom(*this);
+    MoveFrom(temp);
+  }
+
+  explicit operator bool() const noexcept {
+    return ops_ != nullptr;
+  }
+};
+
+template <typename Signature, std::size_t BufferSize = kDefaultFunctionBuffer>
+class Function;
+
+template <typename Signature, std::size_t BufferSize = kDefaultFunctionBuffer>
+class UniqueFunction;
+
+// Copyable callable wrapper, like std::function but with a configurable inline buffer.
+template <typename R, typename... Args, std::size_t BufferSize>
+class Function<R(Args...), BufferSize> : public BasicFunction<true, BufferSize, R, Args...> {
+ private:
+  using Base = BasicFunction<true, BufferSize, R, Args...>;
+
+ public:
+  Function() = default;
+
+  Function(std::nullptr_t) : Base(nullptr) {  // NOLINT
+  }
+
+  template <typename F, typename = typename Base::template EnableIfCallable<F>>
+  Function(F&& callable) : Base(std::forward<F>(callable)) {  // NOLINT
+  }
+
+  template <typename F, typename = typename Base::template EnableIfCallable<F>>
+  Function& operator=(F&& callable) {
+    *this = Function(std::forward<F>(callable));
+    return *this;
+  }
+};
+
+// Move-only callable wrapper; accepts callables that cannot be copied, such as lambdas owning a UniquePtr.
+template <typename R, typename... Args, std::size_t BufferSize>
+class UniqueFunction<R(Args...), BufferSize> : public BasicFunction<false, BufferSize, R, Args...> {
+ private:
+  using Base = BasicFunction<false, BufferSize, R, Args...>;
+
+ public:
+  UniqueFunction() = default;
+
+  UniqueFunction(std::nullptr_t) : Base(nullptr) {  // NOLINT
+  }
+
+  template <typename F, typename = typename Base::template EnableIfCallable<F>>
+  UniqueFunction(F&& callable) : Base(std::forward<F>(callable)) {  // NOLINT
+  }
+
+  UniqueFunction(const UniqueFunction&) = delete;
+  UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+  UniqueFunction(UniqueFunction&&) noexcept = default;
+  UniqueFunction& operator=(UniqueFunction&&) noexcept = default;
+
+  template <typename F, typename = typename Base::template EnableIfCallable<F>>
+  UniqueFunction& operator=(F&& callable) {
+    *this = UniqueFunction(std::forward<F>(callable));
+    return *this;
+  }
+};
+
+#endif
@@ -0,0 +1,108 @@
+// g++ -std=c++17 -O2 function/function_benchmark.cpp -o function_benchmark
+//
+// Dispatch latency and allocations of Function against std::function, for captures of 8, 24 and 64 bytes.
+// libstdc++'s std::function stores at most 16 bytes inline; Function's default buffer holds 24.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+
+#include "function.h"
+
+namespace {
+
+constexpr int kCalls = 100'000'000;
+constexpr int kQueueSize = 1'000'000;
+
+std::size_t allocations = 0;
+
+template <std::size_t Bytes>
+struct Capture {
+  long values[Bytes / sizeof(long)] = {1};
+
+  long operator()(long x) const {
+    return x + values[0];
+  }
+};
+
+// The wrapper is passed by reference through a noinline function, so the call cannot be devirtualized.
+template <typename Wrapper>
+__attribute__((noinline)) long CallMany(const Wrapper& wrapper) {
+  long sum = 0;
+  for (int i = 0; i != kCalls; ++i) {
+    sum = wrapper(sum);
+  }
+  return sum;
+}
+
+template <typename Wrapper, typename Callable>
+void Measure(const char* name, Callable callable) {
+  const Wrapper wrapper(callable);
+  const auto start = std::chrono::steady_clock::now();
+  const long sum = CallMany(wrapper);
+  const double call = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                      kCalls;
+
+  // A task queue: store, move into the queue, call once and drop.
+  const std::size_t allocations_before = allocations;
+  const auto queue_start = std::chrono::steady_clock::now();
+  std::vector<Wrapper> queue;
+  queue.reserve(kQueueSize);
+  for (int i = 0; i != kQueueSize; ++i) {
+    Wrapper task(callable);
+    queue.push_back(std::move(task));
+  }
+  long queue_sum = 0;
+  for (const Wrapper& task : queue) {
+    queue_sum += task(1);
+  }
+  queue.clear();
+  const double enqueue =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - queue_start).count() / kQueueSize;
+  // Less the queue's own buffer.
+  const double per_task = static_cast<double>(allocations - allocations_before - 1) / kQueueSize;
+  asm volatile("" : : "r"(sum + queue_sum));
+  std::printf("%-28s call %5.2f ns, queue round trip %6.2f ns, %.2f allocations per task\n", name, call, enqueue,
+              per_task);
+}
+
+template <std::size_t Bytes>
+void Run() {
+  char std_name[64];
+  char name[64];
+  std::snprintf(std_name, sizeof(std_name), "std::function, %zu bytes", Bytes);
+  std::snprintf(name, sizeof(name), "Function, %zu bytes", Bytes);
+  Measure<std::function<long(long)>>(std_name, Capture<Bytes>{});
+  Measure<Function<long(long)>>(name, Capture<Bytes>{});
+  if constexpr (Bytes > kDefaultFunctionBuffer) {
+    std::snprintf(name, sizeof(name), "Function<.., %zu>, %zu bytes", Bytes, Bytes);
+    Measure<Function<long(long), Bytes>>(name, Capture<Bytes>{});
+  }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+int main() {
+  Run<8>();
+  Run<24>();
+  Run<64>();
+}
@@ -0,0 +1,52 @@
+// g++ -std=c++17 -fsanitize=address,undefined function/function_test.cpp -o function_test
+
+#include <cassert>
+#include <cstdio>
+#include <memory>
+
+#include "function.h"
+
+namespace {
+
+// A void wrapper discards the callable's result, like std::function.
+void VoidDiscardsResult() {
+  int calls = 0;
+  Function<void()> small = [&calls] { return ++calls; };
+  small();
+  long padding[8] = {1};
+  Function<void()> large = [&calls, padding] { return calls += static_cast<int>(padding[0]); };
+  large();
+  Function<void()> copy = large;
+  copy();
+  assert(calls == 3);
+
+  UniqueFunction<void()> unique_small = [&calls, owned = std::make_unique<int>(2)] { return calls += *owned; };
+  unique_small();
+  UniqueFunction<void()> unique_large = [&calls, padding, owned = std::make_unique<int>(3)] {
+    return calls += static_cast<int>(padding[0]) * *owned;
+  };
+  unique_large();
+  assert(calls == 8);
+
+  Function<void(int)> from_pointer = [](int x) { return x; };
+  from_pointer(1);
+}
+
+void EmptyThrows() {
+  Function<int()> empty;
+  bool thrown = false;
+  try {
+    empty();
+  } catch (const BadFunctionCall&) {
+    thrown = true;
+  }
+  assert(thrown && !empty);
+}
+
+}  // namespace
+
+int main() {
+  VoidDiscardsResult();
+  EmptyThrows();
+  std::puts("OK");
+}
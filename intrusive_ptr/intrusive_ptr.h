@@ -0,0 +1,143 @@
+#ifndef INTRUSIVE_PTR_H
+#define INTRUSIVE_PTR_H
+
+#include <utility>
+
+#include "../shared_ptr/ref_count.h"
+
+// Base for objects that carry their own reference count. The count starts at zero and is not copied along with
+// the object. IntrusivePtr finds the hooks below through argument-dependent lookup, so a type may also provide
+// its own IntrusivePtrAddRef/IntrusivePtrRelease/IntrusivePtrUseCount instead of deriving from this class.
+template <typename Derived, typename RefCount = SingleThreadRefCount>
+class IntrusiveRefCounted {
+ private:
+  mutable RefCount ref_count_;
+
+  friend void IntrusivePtrAddRef(const IntrusiveRefCounted* object) {
+    object->ref_count_.Increment();
+  }
+
+  friend void IntrusivePtrRelease(const IntrusiveRefCounted* object) {
+    if (object->ref_count_.Decrement()) {
+      delete static_cast<const Derived*>(object);
+    }
+  }
+
+  friend int IntrusivePtrUseCount(const IntrusiveRefCounted* object) {
+    return object->ref_count_.Load();
+  }
+
+  void SetDeferredRelease() {
+    if constexpr (HasDeferredRelease<RefCount>::value) {
+      ref_count_.SetDeferredRelease(
+          [](void* object) { delete static_cast<const Derived*>(static_cast<const IntrusiveRefCounted*>(object)); },
+          this);
+    }
+  }
+
+ protected:
+  IntrusiveRefCounted() : ref_count_{0} {
+    SetDeferredRelease();
+  }
+
+  IntrusiveRefCounted(const IntrusiveRefCounted&) : ref_count_{0} {
+    SetDeferredRelease();
+  }
+
+  IntrusiveRefCounted& operator=(const IntrusiveRefCounted&) {
+    return *this;
+  }
+
+  ~IntrusiveRefCounted() = default;
+};
+
+template <typename Derived>
+using AtomicIntrusiveRefCounted = IntrusiveRefCounted<Derived, AtomicRefCount>;
+
+template <typename T>
+class IntrusivePtr {
+ private:
+  T* data_;
+
+ public:
+  IntrusivePtr() : data_{nullptr} {
+  }
+
+  // Adopting a raw pointer adds a reference, so a pointer can be rebuilt from any T* that is still alive.
+  IntrusivePtr(T* ptr, bool add_ref = true) : data_{ptr} {  // NOLINT
+    if (data_ && add_ref) {
+      IntrusivePtrAddRef(data_);
+    }
+  }
+
+  IntrusivePtr(const IntrusivePtr& other) : data_{other.data_} {
+    if (data_) {
+      IntrusivePtrAddRef(data_);
+    }
+  }
+
+  IntrusivePtr& operator=(const IntrusivePtr& other) {
+    IntrusivePtr(other).Swap(*this);
+    return *this;
+  }
+
+  IntrusivePtr(IntrusivePtr&& other) noexcept : data_{other.data_} {
+    other.data_ = nullptr;
+  }
+
+  IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+    IntrusivePtr(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  ~IntrusivePtr() {
+    if (data_) {
+      IntrusivePtrRelease(data_);
+    }
+  }
+
+  void Reset(T* ptr = nullptr) {
+    IntrusivePtr(ptr).Swap(*this);
+  }
+
+  // Gives up ownership without dropping the reference.
+  T* Release() {
+    T* temp = data_;
+    data_ = nullptr;
+    return temp;
+  }
+
+  void Swap(IntrusivePtr& other) {
+    std::swap(data_, other.data_);
+  }
+
+  T* Get() const {
+    return data_;
+  }
+
+  int UseCount() const {
+    if (data_) {
+      return IntrusivePtrUseCount(data_);
+    }
+    return 0;
+  }
+
+  T& operator*() const {
+    return *data_;
+  }
+
+  T* operator->() const {
+    return data_;
+  }
+
+  explicit operator bool() const {
+    return static_cast<bool>(data_);
+  }
+};
+
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusive(Args&&... args) {
+  return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const char* path) {
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    throw MappedFileError(std::string("cannot open ") + path + ": " + std::strerror(errno));
+  }
+  struct stat info {};
+  if (fstat(fd, &info) == -1) {
+    const int error = errno;
+    close(fd);
+    throw MappedFileError(std::string("cannot stat ") + path + ": " + std::strerror(error));
+  }
+  size_ = static_cast<std::size_t>(info.st_size);
+  if (size_ != 0) {
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      const int error = errno;
+      close(fd);
+      throw MappedFileError(std::string("cannot map ") + path + ": " + std::strerror(error));
+    }
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapping);
+  }
+  close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : data_{other.data_}, size_{other.size_} {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  Unmap();
+  data_ = other.data_;
+  size_ = other.size_;
+  other.data_ = nullptr;
+  other.size_ = 0;
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+}
+
+void MappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+Vector<StringView> MappedFile::Chunks(std::size_t count) const {
+  Vector<StringView> chunks;
+  if (size_ == 0 || count == 0) {
+    return chunks;
+  }
+  chunks.Reserve(count);
+  std::size_t begin = 0;
+  for (std::size_t i = 1; i <= count && begin != size_; ++i) {
+    std::size_t end = i == count ? size_ : size_ / count * i + size_ % count * i / count;
+    if (end <= begin) {
+      continue;
+    }
+    const auto* newline = static_cast<const char*>(std::memchr(data_ + end - 1, '\n', size_ - end + 1));
+    end = newline ? newline - data_ + 1 : size_;
+    chunks.PushBack({data_ + begin, end - begin});
+    begin = end;
+  }
+  return chunks;
+}
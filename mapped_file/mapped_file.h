@@ -0,0 +1,136 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "../string_view/string_view.h"
+#include "../vector/vector.h"
+
+class MappedFileError : public std::runtime_error {
+ public:
+  explicit MappedFileError(const std::string& what) : std::runtime_error("MappedFileError: " + what) {
+  }
+};
+
+// Yields the lines of a buffer without their '\n'. A trailing newline does not start an extra empty line.
+class LineIterator {
+ private:
+  const char* begin_{};
+  const char* newline_{};
+  const char* end_{};
+
+  void FindNewline() {
+    const auto* found = static_cast<const char*>(std::memchr(begin_, '\n', end_ - begin_));
+    newline_ = found ? found : end_;
+  }
+
+ public:
+  using difference_type = std::ptrdiff_t;               // NOLINT
+  using value_type = StringView;                        // NOLINT
+  using pointer = void;                                 // NOLINT
+  using reference = StringView;                         // NOLINT
+  using iterator_category = std::forward_iterator_tag;  // NOLINT
+
+  LineIterator() = default;
+
+  LineIterator(const char* begin, const char* end) : begin_{begin}, newline_{end}, end_{end} {
+    if (begin_ != end_) {
+      FindNewline();
+    }
+  }
+
+  reference operator*() const {
+    return {begin_, static_cast<std::size_t>(newline_ - begin_)};
+  }
+
+  LineIterator& operator++() {
+    begin_ = newline_ == end_ ? end_ : newline_ + 1;
+    if (begin_ != end_) {
+      FindNewline();
+    }
+    return *this;
+  }
+
+  LineIterator operator++(int) {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+
+  friend bool operator==(const LineIterator& lhs, const LineIterator& rhs) {
+    return lhs.begin_ == rhs.begin_;
+  }
+
+  friend bool operator!=(const LineIterator& lhs, const LineIterator& rhs) {
+    return !(lhs == rhs);
+  }
+};
+
+class LineRange {
+ private:
+  StringView text_;
+
+ public:
+  explicit LineRange(StringView text) : text_{text} {
+  }
+
+  LineIterator begin() const {  // NOLINT
+    return {text_.Data(), text_.Data() + text_.Size()};
+  }
+
+  LineIterator end() const {  // NOLINT
+    return {text_.Data() + text_.Size(), text_.Data() + text_.Size()};
+  }
+};
+
+// Read-only private mapping of a whole file. The mapping is advised for sequential access, so the kernel reads
+// ahead aggressively and drops pages behind the scan.
+class MappedFile {
+ private:
+  const char* data_{};
+  std::size_t size_{};
+
+  void Unmap();
+
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const char* path);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  ~MappedFile();
+
+  const char* Data() const {
+    return data_;
+  }
+
+  std::size_t Size() const {
+    return size_;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  StringView View() const {
+    return {data_, size_};
+  }
+
+  LineRange Lines() const {
+    return LineRange(View());
+  }
+
+  // Splits the contents into at most count pieces of similar size, each ending right after a newline (or at the
+  // end of the file), so that every line belongs to exactly one chunk.
+  Vector<StringView> Chunks(std::size_t count) const;
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "multi_pattern_matcher.h"
+
+namespace {
+
+constexpr uint32_t kNoState = static_cast<uint32_t>(-1);
+
+}  // namespace
+
+MultiPatternMatcher::MultiPatternMatcher(const Vector<StringView>& patterns) : byte_classes_(256, 0) {
+  bool is_start_byte[256] = {};
+  class_count_ = 1;
+  for (const auto& pattern : patterns) {
+    for (std::size_t i = 0; i != pattern.Size(); ++i) {
+      auto& byte_class = byte_classes_[static_cast<uint8_t>(pattern[i])];
+      if (byte_class == 0) {
+        byte_class = static_cast<uint8_t>(class_count_++);
+      }
+    }
+    if (!pattern.Empty()) {
+      is_start_byte[static_cast<uint8_t>(pattern[0])] = true;
+    }
+  }
+  // When all 256 byte values occur there is no class left for unused bytes, so use the identity mapping.
+  if (class_count_ > 256) {
+    for (std::size_t byte = 0; byte != 256; ++byte) {
+      byte_classes_[byte] = static_cast<uint8_t>(byte);
+    }
+    class_count_ = 256;
+  }
+
+  Vector<Vector<uint32_t>> state_outputs(1);
+  transitions_.Resize(class_count_, kNoState);
+  for (std::size_t id = 0; id != patterns.Size(); ++id) {
+    const StringView& pattern = patterns[id];
+    pattern_lengths_.PushBack(pattern.Size());
+    if (pattern.Empty()) {
+      continue;
+    }
+    uint32_t state = 0;
+    for (std::size_t i = 0; i != pattern.Size(); ++i) {
+      const std::size_t slot = state * class_count_ + byte_classes_[static_cast<uint8_t>(pattern[i])];
+      if (transitions_[slot] == kNoState) {
+        transitions_[slot] = static_cast<uint32_t>(state_outputs.Size());
+        state_outputs.EmplaceBack();
+        transitions_.Resize(transitions_.Size() + class_count_, kNoState);
+      }
+      state = transitions_[slot];
+    }
+    state_outputs[state].PushBack(static_cast<uint32_t>(id));
+  }
+
+  // Breadth-first pass turning the trie into a full DFA: missing edges follow the failure link, and each state
+  // inherits the outputs of its failure state, which is always shallower and therefore already complete.
+  const std::size_t state_count = state_outputs.Size();
+  Vector<uint32_t> failure(state_count, 0);
+  Vector<uint32_t> queue;
+  queue.Reserve(state_count);
+  for (std::size_t c = 0; c != class_count_; ++c) {
+    uint32_t& next = transitions_[c];
+    if (next == kNoState) {
+      next = 0;
+    } else {
+      queue.PushBack(next);
+    }
+  }
+  for (std::size_t head = 0; head != queue.Size(); ++head) {
+    const uint32_t state = queue[head];
+    for (const uint32_t id : state_outputs[failure[state]]) {
+      state_outputs[state].PushBack(id);
+    }
+    for (std::size_t c = 0; c != class_count_; ++c) {
+      uint32_t& next = transitions_[state * class_count_ + c];
+      const uint32_t fallback = transitions_[failure[state] * class_count_ + c];
+      if (next == kNoState) {
+        next = fallback;
+      } else {
+        failure[next] = fallback;
+        queue.PushBack(next);
+      }
+    }
+  }
+
+  for (auto& next : transitions_) {
+    next = next * static_cast<uint32_t>(class_count_) | (state_outputs[next].Empty() ? 0 : kOutputFlag);
+  }
+
+  output_offsets_.Reserve(state_count + 1);
+  output_offsets_.PushBack(0);
+  for (const auto& ids : state_outputs) {
+    for (const uint32_t id : ids) {
+      outputs_.PushBack(id);
+    }
+    output_offsets_.PushBack(static_cast<uint32_t>(outputs_.Size()));
+  }
+
+  BuildPrefilter(is_start_byte);
+}
+
+void MultiPatternMatcher::BuildPrefilter(const bool (&is_start_byte)[256]) {
+  // Start bytes are bucketed by the low three bits of their high nibble, so the nibble test only confuses
+  // bytes whose high nibbles differ by 8.
+  for (std::size_t byte = 0; byte != 256; ++byte) {
+    if (is_start_byte[byte]) {
+      start_bytes_.PushBack(static_cast<uint8_t>(byte));
+      const auto bucket = static_cast<uint8_t>(1 << ((byte >> 4) & 7));
+      low_nibble_masks_[byte & 0x0F] |= bucket;
+      high_nibble_masks_[byte >> 4] |= bucket;
+    }
+  }
+  std::size_t candidates = 0;
+  for (std::size_t byte = 0; byte != 256; ++byte) {
+    candidates += (low_nibble_masks_[byte & 0x0F] & high_nibble_masks_[byte >> 4]) != 0;
+  }
+  if (start_bytes_.Empty()) {
+    prefilter_ = Prefilter::kNibbles;
+  } else if (start_bytes_.Size() <= kMaxPrefilterBytes) {
+    prefilter_ = Prefilter::kBytes;
+  } else if (candidates <= kMaxPrefilterCandidates) {
+    prefilter_ = Prefilter::kNibbles;
+  } else {
+    prefilter_ = Prefilter::kNone;
+  }
+}
+
+Vector<PatternMatch> MultiPatternMatcher::FindAll(StringView haystack) const {
+  Vector<PatternMatch> matches;
+  ForEachMatch(haystack, [&matches](const PatternMatch& match) { matches.PushBack(match); });
+  return matches;
+}
+
+bool MultiPatternMatcher::ContainsAny(StringView haystack) const {
+  bool found = false;
+  ForEachMatch(haystack, [&found](const PatternMatch&) {
+    found = true;
+    return false;
+  });
+  return found;
+}
@@ -0,0 +1,141 @@
+#ifndef MULTI_PATTERN_MATCHER_H
+#define MULTI_PATTERN_MATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../string_view/string_view.h"
+#include "../vector/vector.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+struct PatternMatch {
+  std::size_t pattern_id;
+  std::size_t offset;
+};
+
+// Aho-Corasick automaton over a fixed set of literal patterns. Every occurrence of every pattern is reported,
+// including overlapping ones, in order of the position where it ends. Empty patterns never match.
+// A callback returning bool stops the scan by returning false.
+class MultiPatternMatcher {
+ private:
+  enum class Prefilter { kNone, kBytes, kNibbles };
+
+  // Transitions hold the row offset of the target state; the high bit marks states that report matches.
+  static constexpr uint32_t kOutputFlag = 1U << 31;
+  static constexpr std::size_t kMaxPrefilterBytes = 3;
+  static constexpr std::size_t kMaxPrefilterCandidates = 64;
+
+  Vector<uint8_t> byte_classes_;
+  std::size_t class_count_{};
+  Vector<uint32_t> transitions_;
+  Vector<uint32_t> output_offsets_;
+  Vector<uint32_t> outputs_;
+  Vector<std::size_t> pattern_lengths_;
+
+  Prefilter prefilter_ = Prefilter::kNone;
+  Vector<uint8_t> start_bytes_;
+  uint8_t low_nibble_masks_[16] = {};
+  uint8_t high_nibble_masks_[16] = {};
+
+  void BuildPrefilter(const bool (&is_start_byte)[256]);
+  std::size_t NextCandidate(const uint8_t*, std::size_t, std::size_t) const;
+
+ public:
+  explicit MultiPatternMatcher(const Vector<StringView>& patterns);
+
+  std::size_t PatternCount() const {
+    return pattern_lengths_.Size();
+  }
+
+  std::size_t StateCount() const {
+    return output_offsets_.Size() - 1;
+  }
+
+  template <typename Callback>
+  void ForEachMatch(StringView haystack, Callback&& callback) const {
+    const auto* data = reinterpret_cast<const uint8_t*>(haystack.Data());
+    const std::size_t size = haystack.Size();
+    uint32_t row = 0;
+    std::size_t i = 0;
+    while (i < size) {
+      if (row == 0 && prefilter_ != Prefilter::kNone) {
+        i = NextCandidate(data, i, size);
+        if (i == size) {
+          break;
+        }
+      }
+      const uint32_t next = transitions_[row + byte_classes_[data[i]]];
+      row = next & ~kOutputFlag;
+      ++i;
+      if ((next & kOutputFlag) == 0) {
+        continue;
+      }
+      const std::size_t state = row / class_count_;
+      for (uint32_t k = output_offsets_[state]; k != output_offsets_[state + 1]; ++k) {
+        const uint32_t id = outputs_[k];
+        if constexpr (std::is_same_v<std::invoke_result_t<Callback&, const PatternMatch&>, bool>) {
+          if (!callback(PatternMatch{id, i - pattern_lengths_[id]})) {
+            return;
+          }
+        } else {
+          callback(PatternMatch{id, i - pattern_lengths_[id]});
+        }
+      }
+    }
+  }
+
+  Vector<PatternMatch> FindAll(StringView haystack) const;
+  bool ContainsAny(StringView haystack) const;
+};
+
+inline std::size_t MultiPatternMatcher::NextCandidate(const uint8_t* data, std::size_t pos, std::size_t size) const {
+#if defined(__SSE2__)
+  if (prefilter_ == Prefilter::kBytes) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(start_bytes_[0]));
+    const __m128i second = _mm_set1_epi8(static_cast<char>(start_bytes_[start_bytes_.Size() > 1 ? 1 : 0]));
+    const __m128i third = _mm_set1_epi8(static_cast<char>(start_bytes_[start_bytes_.Size() - 1]));
+    for (; pos + 16 <= size; pos += 16) {
+      const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+      const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, first), _mm_cmpeq_epi8(block, second)),
+                                        _mm_cmpeq_epi8(block, third));
+      const int mask = _mm_movemask_epi8(hits);
+      if (mask != 0) {
+        return pos + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+#if defined(__SSSE3__)
+  if (prefilter_ == Prefilter::kNibbles) {
+    const __m128i low_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(low_nibble_masks_));
+    const __m128i high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(high_nibble_masks_));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    for (; pos + 16 <= size; pos += 16) {
+      const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+      const __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(block, nibble));
+      const __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+      const __m128i empty = _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128());
+      const int mask = ~_mm_movemask_epi8(empty) & 0xFFFF;
+      if (mask != 0) {
+        return pos + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; pos != size; ++pos) {
+    const uint8_t byte = data[pos];
+    if (low_nibble_masks_[byte & 0x0F] & high_nibble_masks_[byte >> 4]) {
+      return pos;
+    }
+  }
+  return size;
+}
+
+#endif
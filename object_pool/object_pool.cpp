@@ -0,0 +1,213 @@
+#include "object_pool.h"
+
+namespace {
+
+std::atomic<uint64_t> next_pool_id{1};
+
+std::mutex index_mutex;
+std::vector<std::size_t> free_indices;
+std::size_t next_index = 0;
+
+std::size_t AcquireIndex() {
+  std::lock_guard<std::mutex> lock(index_mutex);
+  if (free_indices.empty()) {
+    return next_index++;
+  }
+  std::size_t index = free_indices.back();
+  free_indices.pop_back();
+  return index;
+}
+
+void ReleaseIndex(std::size_t index) {
+  std::lock_guard<std::mutex> lock(index_mutex);
+  free_indices.push_back(index);
+}
+
+}  // namespace
+
+thread_local ObjectPoolBase::CacheTable ObjectPoolBase::cache_table;
+
+ObjectPoolBase::CacheTable::~CacheTable() {
+  for (const Entry& entry : entries) {
+    if (entry.cache) {
+      entry.cache->orphaned.store(true, std::memory_order_release);
+      Release(entry.cache);
+    }
+  }
+}
+
+void ObjectPoolBase::Release(Cache* cache) {
+  if (cache->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete cache;
+  }
+}
+
+ObjectPoolBase::ObjectPoolBase(std::size_t slot_size, std::size_t alignment, const PoolOptions& options)
+    : slot_size_{slot_size},
+      alignment_{static_cast<std::align_val_t>(alignment)},
+      options_{options},
+      id_{next_pool_id.fetch_add(1, std::memory_order_relaxed)},
+      index_{AcquireIndex()} {
+  for (std::size_t i = 0; i != options_.warm_up; ++i) {
+    auto* slot = static_cast<FreeSlot*>(::operator new(slot_size_, alignment_));
+    slot->next = free_list_;
+    free_list_ = slot;
+  }
+  free_count_ = options_.warm_up;
+  slots_ = options_.warm_up;
+}
+
+ObjectPoolBase::~ObjectPoolBase() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FreeSlots(free_list_);
+  Cache* cache = caches_;
+  while (cache) {
+    Cache* next = cache->next;
+    FreeSlots(cache->head);
+    cache->head = nullptr;
+    Release(cache);
+    cache = next;
+  }
+  ReleaseIndex(index_);
+}
+
+void ObjectPoolBase::FreeSlots(FreeSlot* head) {
+  while (head) {
+    FreeSlot* next = head->next;
+    ::operator delete(head, slot_size_, alignment_);
+    head = next;
+  }
+}
+
+ObjectPoolBase::Cache* ObjectPoolBase::AttachCache() {
+  auto& entries = cache_table.entries;
+  if (entries.size() <= index_) {
+    entries.resize(index_ + 1);
+  }
+  // A different id means the pool that used this index is gone; drop the thread's share of its cache.
+  if (entries[index_].cache) {
+    Release(entries[index_].cache);
+    entries[index_] = {};
+  }
+  auto* cache = new Cache();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache->next = caches_;
+    caches_ = cache;
+  }
+  entries[index_] = {id_, cache};
+  return cache;
+}
+
+ObjectPoolBase::FreeSlot* ObjectPoolBase::ReclaimOrphanedCaches() {
+  FreeSlot* excess = nullptr;
+  Cache** link = &caches_;
+  while (Cache* other = *link) {
+    if (!other->orphaned.load(std::memory_order_acquire)) {
+      link = &other->next;
+      continue;
+    }
+    // The owning thread has exited and will not touch the cache again: take its slots and drop it, so the list
+    // only ever holds caches of live threads.
+    FreeSlot* slot = other->head;
+    while (slot) {
+      FreeSlot* next = slot->next;
+      if (free_count_ < options_.capacity) {
+        slot->next = free_list_;
+        free_list_ = slot;
+        ++free_count_;
+      } else {
+        slot->next = excess;
+        excess = slot;
+        --slots_;
+      }
+      slot = next;
+    }
+    other->head = nullptr;
+    shared_hits_ += other->hits.load(std::memory_order_relaxed);
+    *link = other->next;
+    Release(other);
+  }
+  return excess;
+}
+
+void* ObjectPoolBase::AllocateSlow(Cache* cache) {
+  FreeSlot* excess;
+  FreeSlot* result = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    excess = ReclaimOrphanedCaches();
+    if (free_list_) {
+      // Take up to half a cache worth, so the next few acquisitions stay on the fast path.
+      const std::size_t batch = std::max<std::size_t>(1, options_.thread_cache_size / 2);
+      result = free_list_;
+      free_list_ = result->next;
+      --free_count_;
+      std::size_t taken = 0;
+      while (free_list_ && taken + 1 < batch) {
+        FreeSlot* slot = free_list_;
+        free_list_ = slot->next;
+        slot->next = cache->head;
+        cache->head = slot;
+        ++taken;
+      }
+      free_count_ -= taken;
+      SetCount(cache, Count(cache) + taken);
+      ++shared_hits_;
+    } else {
+      ++misses_;
+      ++slots_;
+    }
+  }
+  FreeSlots(excess);
+  if (result) {
+    return result;
+  }
+  try {
+    return ::operator new(slot_size_, alignment_);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --misses_;
+    --slots_;
+    throw;
+  }
+}
+
+void ObjectPoolBase::DeallocateSlow(Cache* cache) {
+  const std::size_t keep = options_.thread_cache_size / 2;
+  std::size_t count = Count(cache);
+  FreeSlot* excess = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (count > keep) {
+      FreeSlot* slot = cache->head;
+      cache->head = slot->next;
+      --count;
+      if (free_count_ < options_.capacity) {
+        slot->next = free_list_;
+        free_list_ = slot;
+        ++free_count_;
+      } else {
+        slot->next = excess;
+        excess = slot;
+        --slots_;
+      }
+    }
+    SetCount(cache, count);
+  }
+  FreeSlots(excess);
+}
+
+PoolStats ObjectPoolBase::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PoolStats stats;
+  stats.hits = shared_hits_;
+  stats.misses = misses_;
+  stats.idle = free_count_;
+  for (Cache* cache = caches_; cache; cache = cache->next) {
+    stats.hits += cache->hits.load(std::memory_order_relaxed);
+    stats.idle += Count(cache);
+  }
+  stats.live = slots_ - stats.idle;
+  return stats;
+}
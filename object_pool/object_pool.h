@@ -0,0 +1,181 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "../unique_ptr/unique_ptr.h"
+
+struct PoolOptions {
+  // Idle slots kept in the shared freelist; slots released beyond it go back to the heap. Each thread cache
+  // may hold up to thread_cache_size more.
+  std::size_t capacity = SIZE_MAX;
+  // Slots allocated up front by the constructor.
+  std::size_t warm_up = 0;
+  std::size_t thread_cache_size = 64;
+};
+
+struct PoolStats {
+  std::size_t hits = 0;    // acquisitions served from recycled slots
+  std::size_t misses = 0;  // acquisitions that had to allocate
+  std::size_t idle = 0;
+  std::size_t live = 0;
+};
+
+// Untyped part of ObjectPool: recycles fixed-size slots. Each thread keeps a private cache per pool and trades
+// batches with the shared freelist under the pool mutex, so most acquisitions and releases touch only
+// thread-local memory. A cache is shared between its thread and the pool and freed by whichever lets go last;
+// caches of exited threads are drained and unlinked by the pool on its next slow-path acquisition.
+class ObjectPoolBase {
+ private:
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  // Counters are written only by the owning thread and read by Stats().
+  struct Cache {
+    FreeSlot* head = nullptr;
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::size_t> hits{0};
+    std::atomic<bool> orphaned{false};
+    std::atomic<int> owners{2};
+    Cache* next = nullptr;
+  };
+
+  // Per-thread table of caches, indexed by pool index. An entry is valid only while its pool id matches,
+  // because indices of destroyed pools are reused.
+  struct CacheTable {
+    struct Entry {
+      uint64_t pool_id = 0;
+      Cache* cache = nullptr;
+    };
+
+    std::vector<Entry> entries;
+
+    ~CacheTable();
+  };
+
+  static thread_local CacheTable cache_table;
+
+  const std::size_t slot_size_;
+  const std::align_val_t alignment_;
+  const PoolOptions options_;
+  const uint64_t id_;
+  const std::size_t index_;
+
+  std::mutex mutex_;
+  FreeSlot* free_list_ = nullptr;
+  std::size_t free_count_ = 0;
+  std::size_t slots_ = 0;
+  std::size_t misses_ = 0;
+  std::size_t shared_hits_ = 0;
+  Cache* caches_ = nullptr;
+
+  static void Release(Cache* cache);
+
+  Cache* LocalCache() {
+    const auto& entries = cache_table.entries;
+    if (index_ < entries.size() && entries[index_].pool_id == id_) {
+      return entries[index_].cache;
+    }
+    return AttachCache();
+  }
+
+  static std::size_t Count(const Cache* cache) {
+    return cache->count.load(std::memory_order_relaxed);
+  }
+
+  static void SetCount(Cache* cache, std::size_t count) {
+    cache->count.store(count, std::memory_order_relaxed);
+  }
+
+  Cache* AttachCache();
+  FreeSlot* ReclaimOrphanedCaches();
+  void* AllocateSlow(Cache* cache);
+  void DeallocateSlow(Cache* cache);
+  void FreeSlots(FreeSlot* head);
+
+ protected:
+  ObjectPoolBase(std::size_t slot_size, std::size_t alignment, const PoolOptions& options);
+  ~ObjectPoolBase();
+
+  void* Allocate() {
+    Cache* cache = LocalCache();
+    FreeSlot* slot = cache->head;
+    if (slot == nullptr) {
+      return AllocateSlow(cache);
+    }
+    cache->head = slot->next;
+    SetCount(cache, Count(cache) - 1);
+    cache->hits.store(cache->hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return slot;
+  }
+
+  void Deallocate(void* ptr) {
+    Cache* cache = LocalCache();
+    auto* slot = static_cast<FreeSlot*>(ptr);
+    slot->next = cache->head;
+    cache->head = slot;
+    const std::size_t count = Count(cache) + 1;
+    SetCount(cache, count);
+    if (count > options_.thread_cache_size) {
+      DeallocateSlow(cache);
+    }
+  }
+
+ public:
+  ObjectPoolBase(const ObjectPoolBase&) = delete;
+  ObjectPoolBase& operator=(const ObjectPoolBase&) = delete;
+
+  PoolStats Stats();
+};
+
+// Recycles the memory of T objects. Acquire constructs an object in a recycled slot when one is available and
+// returns a UniquePtr whose deleter destroys the object and hands the slot back to the pool. The pool must
+// outlive every handle it gave out and must not be destroyed while another thread is still using it.
+template <typename T>
+class ObjectPool : private ObjectPoolBase {
+ public:
+  class Recycler {
+   private:
+    ObjectPool* pool_;
+
+   public:
+    explicit Recycler(ObjectPool* pool = nullptr) : pool_{pool} {
+    }
+
+    void operator()(T* object) const {
+      object->~T();
+      pool_->Deallocate(object);
+    }
+  };
+
+  using Handle = UniquePtr<T, Recycler>;
+
+  explicit ObjectPool(const PoolOptions& options = {})
+      : ObjectPoolBase(std::max(sizeof(T), sizeof(void*)), std::max(alignof(T), alignof(void*)), options) {
+  }
+
+  template <typename... Args>
+  Handle Acquire(Args&&... args) {
+    void* slot = Allocate();
+    T* object;
+    try {
+      object = new (slot) T(std::forward<Args>(args)...);
+    } catch (...) {
+      Deallocate(slot);
+      throw;
+    }
+    return Handle(object, Recycler(this));
+  }
+
+  using ObjectPoolBase::Stats;
+};
+
+#endif
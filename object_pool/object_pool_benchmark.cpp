@@ -0,0 +1,86 @@
+// g++ -std=c++17 -O2 -pthread object_pool/object_pool.cpp object_pool/object_pool_benchmark.cpp -o pool_benchmark
+//
+// ObjectPool::Acquire and handle destruction against MakeUnique with plain new/delete, for a 128-byte message.
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "object_pool.h"
+
+namespace {
+
+constexpr int kIterations = 20'000'000;
+constexpr int kBatch = 1000;
+
+struct Message {
+  int id;
+  char body[124];
+
+  explicit Message(int i) : id{i} {
+  }
+};
+
+template <typename F>
+double NanosecondsPerIteration(int iterations, F&& body) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i != iterations; ++i) {
+    body(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+template <typename Make>
+double OneAtATime(Make&& make) {
+  return NanosecondsPerIteration(kIterations, [&](int i) {
+    auto message = make(i);
+    asm volatile("" : : "r"(message.Get()) : "memory");
+  });
+}
+
+// Holds kBatch messages at once, so the pool cycles slots through its shared freelist.
+template <typename Make>
+double Batched(Make&& make) {
+  using Handle = decltype(make(0));
+  std::vector<Handle> batch;
+  batch.reserve(kBatch);
+  return NanosecondsPerIteration(kIterations / kBatch, [&](int) {
+           for (int i = 0; i != kBatch; ++i) {
+             batch.push_back(make(i));
+           }
+           batch.clear();
+         }) /
+         kBatch;
+}
+
+template <typename F>
+double Threaded(int threads, F&& run) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t != threads; ++t) {
+    workers.emplace_back(run);
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         (static_cast<double>(kIterations) * threads);
+}
+
+}  // namespace
+
+int main() {
+  ObjectPool<Message> pool;
+  auto acquire = [&pool](int i) { return pool.Acquire(i); };
+  auto make_unique = [](int i) { return MakeUnique<Message>(i); };
+  std::printf("one at a time:      ObjectPool %6.2f ns, new/delete %6.2f ns\n", OneAtATime(acquire),
+              OneAtATime(make_unique));
+  std::printf("%d live:          ObjectPool %6.2f ns, new/delete %6.2f ns\n", kBatch, Batched(acquire),
+              Batched(make_unique));
+  std::printf("4 threads, %d live: ObjectPool %6.2f ns, new/delete %6.2f ns\n", kBatch,
+              Threaded(4, [&] { Batched(acquire); }), Threaded(4, [&] { Batched(make_unique); }));
+  const PoolStats stats = pool.Stats();
+  std::printf("pool stats: %zu hits, %zu misses, %zu idle, %zu live\n", stats.hits, stats.misses, stats.idle,
+              stats.live);
+}
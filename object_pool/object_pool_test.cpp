@@ -0,0 +1,89 @@
+// g++ -std=c++17 -pthread object_pool/object_pool.cpp object_pool/object_pool_test.cpp -o object_pool_test
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "object_pool.h"
+
+namespace {
+
+std::atomic<long> live_allocations{0};
+
+struct Message {
+  int id;
+  char body[120];
+
+  explicit Message(int i) : id{i} {
+  }
+};
+
+void RunShortLivedThreads(ObjectPool<Message>& pool, int threads) {
+  for (int i = 0; i != threads; ++i) {
+    std::thread([&pool, i] {
+      auto first = pool.Acquire(i);
+      auto second = pool.Acquire(i + 1);
+      assert(first->id == i && second->id == i + 1);
+    }).join();
+  }
+}
+
+// Caches of exited threads are reclaimed, so a pool used by thread-per-task workers does not grow with the
+// number of threads that ever touched it.
+void ThreadPerTask() {
+  ObjectPool<Message> pool;
+  RunShortLivedThreads(pool, 100);
+  const long before = live_allocations.load();
+  RunShortLivedThreads(pool, 1000);
+  assert(live_allocations.load() - before < 10);
+  const PoolStats stats = pool.Stats();
+  assert(stats.live == 0);
+  assert(stats.misses <= 4);
+}
+
+void CapacityLimit() {
+  PoolOptions options;
+  options.capacity = 1;
+  options.thread_cache_size = 4;
+  ObjectPool<Message> pool(options);
+  std::thread([&pool] {
+    std::vector<ObjectPool<Message>::Handle> handles;
+    for (int i = 0; i != 3; ++i) {
+      handles.push_back(pool.Acquire(i));
+    }
+  }).join();
+  pool.Acquire(0);
+  const PoolStats stats = pool.Stats();
+  assert(stats.live == 0 && stats.idle <= 1 + options.thread_cache_size);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  live_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  if (ptr) {
+    live_allocations.fetch_sub(1, std::memory_order_relaxed);
+  }
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  operator delete(ptr);
+}
+
+int main() {
+  ThreadPerTask();
+  CapacityLimit();
+  std::puts("OK");
+}
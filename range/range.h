@@ -2,6 +2,8 @@
 #define RANGE_H
 #define REVERSE_RANGE_IMPLEMENTED
 
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 
 class RangeIterator {
@@ -14,7 +16,7 @@ class RangeIterator {
   using value_type = int64_t;                                 // NOLINT
   using pointer = void;                                       // NOLINT
   using reference = int64_t;                                  // NOLINT
-  using iterator_category = std::bidirectional_iterator_tag;  // NOLINT
+  using iterator_category = std::random_access_iterator_tag;  // NOLINT
 
   RangeIterator() noexcept : state_{0} {
   }
@@ -47,11 +49,42 @@ class RangeIterator {
     return *this;
   }
 
+  RangeIterator& operator+=(difference_type count) noexcept {
+    state_ += count * step_;
+    return *this;
+  }
+
+  RangeIterator& operator-=(difference_type count) noexcept {
+    state_ -= count * step_;
+    return *this;
+  }
+
+  RangeIterator operator+(difference_type count) const noexcept {
+    return {state_ + count * step_, step_};
+  }
+
+  RangeIterator operator-(difference_type count) const noexcept {
+    return {state_ - count * step_, step_};
+  }
+
+  // Both iterators must come from the same range, so the distance is a whole number of steps.
+  difference_type operator-(const RangeIterator& other) const noexcept {
+    return (state_ - other.state_) / step_;
+  }
+
   reference operator*() const noexcept {
     return state_;
   }
+
+  reference operator[](difference_type index) const noexcept {
+    return state_ + index * step_;
+  }
 };
 
+inline RangeIterator operator+(RangeIterator::difference_type count, const RangeIterator& iter) noexcept {
+  return iter + count;
+}
+
 inline bool operator==(const RangeIterator& lhs, const RangeIterator& rhs) {
   return *lhs == *rhs;
 }
@@ -60,6 +93,23 @@ inline bool operator!=(const RangeIterator& lhs, const RangeIterator& rhs) {
   return !(lhs == rhs);
 }
 
+// Ordered by position in the range, which for a negative step is the reverse of the value order.
+inline bool operator<(const RangeIterator& lhs, const RangeIterator& rhs) {
+  return lhs - rhs < 0;
+}
+
+inline bool operator>(const RangeIterator& lhs, const RangeIterator& rhs) {
+  return rhs < lhs;
+}
+
+inline bool operator<=(const RangeIterator& lhs, const RangeIterator& rhs) {
+  return !(rhs < lhs);
+}
+
+inline bool operator>=(const RangeIterator& lhs, const RangeIterator& rhs) {
+  return !(lhs < rhs);
+}
+
 class RangeProxy {
  public:
   using value_type = RangeIterator::value_type;              // NOLINT
@@ -77,6 +127,10 @@ class RangeProxy {
   RangeProxy(value_type begin, value_type end, value_type step = 1) noexcept : begin_{begin}, end_{end}, step_{step} {
     if ((end < begin && step > 0) || (begin < end && step < 0) || step == 0) {
       end_ = begin;
+      // A zero step would make size() and iterator differences divide by zero.
+      if (step == 0) {
+        step_ = 1;
+      }
       return;
     }
 
@@ -94,6 +148,10 @@ class RangeProxy {
     return {end_, step_};
   }
 
+  std::size_t size() const noexcept {  // NOLINT
+    return static_cast<std::size_t>((end_ - begin_) / step_);
+  }
+
   reverse_itetator rbegin() const noexcept {  // NOLINT
     return std::make_reverse_iterator(end());
   }
@@ -0,0 +1,66 @@
+// g++ -std=c++17 -fsanitize=address,undefined range/range_test.cpp -o range_test
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "range.h"
+
+namespace {
+
+void ZeroStep() {
+  auto range = Range(0, 10, 0);
+  assert(range.size() == 0);
+  assert(range.end() - range.begin() == 0);
+  assert(range.begin() == range.end());
+  assert(std::distance(range.begin(), range.end()) == 0);
+}
+
+// Every operation agrees with the same range materialized into a vector.
+void MatchesVector() {
+  for (int64_t begin = -12; begin <= 12; ++begin) {
+    for (int64_t end = -12; end <= 12; ++end) {
+      for (int64_t step : {-5, -3, -1, 0, 1, 2, 7}) {
+        auto range = Range(begin, end, step);
+        std::vector<int64_t> values(range.begin(), range.end());
+        assert(range.size() == values.size());
+        assert(range.end() - range.begin() == static_cast<int64_t>(values.size()));
+        for (std::size_t i = 0; i != values.size(); ++i) {
+          assert(range.begin()[i] == values[i]);
+          assert(*(range.begin() + i) == values[i]);
+          assert(*(range.end() - (values.size() - i)) == values[i]);
+          assert(range.begin() + i < range.end());
+        }
+        std::vector<int64_t> reversed(range.rbegin(), range.rend());
+        std::reverse(reversed.begin(), reversed.end());
+        assert(reversed == values);
+        for (int64_t x = -15; x <= 15; ++x) {
+          if (step >= 0) {
+            assert(std::lower_bound(range.begin(), range.end(), x) - range.begin() ==
+                   std::lower_bound(values.begin(), values.end(), x) - values.begin());
+          } else {
+            assert(std::lower_bound(range.begin(), range.end(), x, std::greater<>()) - range.begin() ==
+                   std::lower_bound(values.begin(), values.end(), x, std::greater<>()) - values.begin());
+          }
+        }
+      }
+    }
+  }
+}
+
+void SingleArgument() {
+  assert(Range(5).size() == 5);
+  assert(Range(-3).size() == 0);
+}
+
+}  // namespace
+
+int main() {
+  ZeroStep();
+  MatchesVector();
+  SingleArgument();
+  std::puts("OK");
+}
@@ -0,0 +1,155 @@
+#ifndef ATOMIC_SHARED_PTR_H
+#define ATOMIC_SHARED_PTR_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "shared_ptr.h"
+
+// Lock-free atomic slot holding a SharedPtr with atomic reference counts.
+//
+// The slot points at an immutable node that owns one SharedPtr, and the top 16 bits of the same word count the
+// readers currently inside Load(). A reader bumps that local count with one fetch_add, which pins the node,
+// copies the SharedPtr out and then returns the local count. A writer swaps in a new node and transfers the
+// local count it displaced to the old node's own count, so readers that are still copying from the old node
+// keep it alive and release it themselves. The pointer part relies on user-space addresses fitting in 48 bits.
+template <typename T>
+class AtomicSharedPtr {
+ public:
+  using Pointer = SharedPtr<T, AtomicRefCount>;
+
+ private:
+  struct Node {
+    Pointer value_;
+    std::atomic<int64_t> references_;
+
+    explicit Node(Pointer value) : value_{std::move(value)}, references_{1} {
+    }
+  };
+
+  static_assert(sizeof(void*) == sizeof(uint64_t), "AtomicSharedPtr packs pointers into 48 bits");
+
+  static constexpr int kCountShift = 48;
+  static constexpr uint64_t kPointerMask = (uint64_t{1} << kCountShift) - 1;
+  static constexpr uint64_t kOneReader = uint64_t{1} << kCountShift;
+
+  mutable std::atomic<uint64_t> word_;
+
+  static Node* NodeOf(uint64_t word) {
+    return reinterpret_cast<Node*>(word & kPointerMask);
+  }
+
+  static int64_t ReadersOf(uint64_t word) {
+    return static_cast<int64_t>(word >> kCountShift);
+  }
+
+  static Node* MakeNode(Pointer value) {
+    return value.GetCounter() ? new Node(std::move(value)) : nullptr;
+  }
+
+  static void Unreference(Node* node, int64_t count) {
+    if (node != nullptr && node->references_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+      delete node;
+    }
+  }
+
+  Node* AcquireReader() const {
+    return NodeOf(word_.fetch_add(kOneReader, std::memory_order_acquire));
+  }
+
+  void ReleaseReader(Node* node) const {
+    uint64_t current = word_.load(std::memory_order_relaxed);
+    while (NodeOf(current) == node && ReadersOf(current) != 0) {
+      if (word_.compare_exchange_weak(current, current - kOneReader, std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    // The node was swapped out and the writer moved our reader reference into the node's own count.
+    Unreference(node, 1);
+  }
+
+  // Credits the readers displaced by a swap to the old node and drops the slot's own reference; extra counts
+  // references the caller itself held as a reader.
+  static void RetireNode(uint64_t old_word, int64_t extra = 0) {
+    Node* node = NodeOf(old_word);
+    if (node != nullptr) {
+      const int64_t delta = ReadersOf(old_word) - 1 - extra;
+      if (node->references_.fetch_add(delta, std::memory_order_acq_rel) + delta == 0) {
+        delete node;
+      }
+    }
+  }
+
+  static bool SameOwner(const Node* node, const Pointer& pointer) {
+    if (node == nullptr) {
+      return pointer.GetCounter() == nullptr;
+    }
+    return node->value_.Get() == pointer.Get() && node->value_.GetCounter() == pointer.GetCounter();
+  }
+
+ public:
+  AtomicSharedPtr() noexcept : word_{0} {
+  }
+
+  AtomicSharedPtr(Pointer value) : word_{reinterpret_cast<uint64_t>(MakeNode(std::move(value)))} {  // NOLINT
+  }
+
+  AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+  AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+  ~AtomicSharedPtr() {
+    RetireNode(word_.load(std::memory_order_acquire));
+  }
+
+  bool IsLockFree() const noexcept {
+    return word_.is_lock_free();
+  }
+
+  Pointer Load() const {
+    Node* node = AcquireReader();
+    Pointer result = node ? node->value_ : Pointer();
+    ReleaseReader(node);
+    return result;
+  }
+
+  void Store(Pointer desired) {
+    RetireNode(word_.exchange(reinterpret_cast<uint64_t>(MakeNode(std::move(desired))), std::memory_order_acq_rel));
+  }
+
+  Pointer Exchange(Pointer desired) {
+    const uint64_t old_word =
+        word_.exchange(reinterpret_cast<uint64_t>(MakeNode(std::move(desired))), std::memory_order_acq_rel);
+    Node* node = NodeOf(old_word);
+    Pointer result = node ? node->value_ : Pointer();
+    RetireNode(old_word);
+    return result;
+  }
+
+  // Replaces the value with desired if it still owns the same object as expected; otherwise loads the current
+  // value into expected. Never fails spuriously.
+  bool CompareExchange(Pointer& expected, Pointer desired) {
+    Node* fresh = MakeNode(std::move(desired));
+    while (true) {
+      Node* node = AcquireReader();
+      if (!SameOwner(node, expected)) {
+        expected = node ? node->value_ : Pointer();
+        ReleaseReader(node);
+        Unreference(fresh, 1);
+        return false;
+      }
+      uint64_t current = word_.load(std::memory_order_relaxed);
+      while (NodeOf(current) == node) {
+        if (word_.compare_exchange_weak(current, reinterpret_cast<uint64_t>(fresh), std::memory_order_acq_rel,
+                                        std::memory_order_relaxed)) {
+          RetireNode(current, 1);
+          return true;
+        }
+      }
+      ReleaseReader(node);
+    }
+  }
+};
+
+#endif
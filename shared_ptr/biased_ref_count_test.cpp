@@ -0,0 +1,60 @@
+// g++ -std=c++17 -pthread -fsanitize=address shared_ptr/biased_ref_count_test.cpp -o biased_ref_count_test
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <thread>
+
+#include "../intrusive_ptr/intrusive_ptr.h"
+#include "ref_count.h"
+
+namespace {
+
+std::atomic<int> live{0};
+
+struct Node : IntrusiveRefCounted<Node, BiasedRefCount> {
+  Node() {
+    live.fetch_add(1);
+  }
+
+  ~Node() {
+    live.fetch_sub(1);
+  }
+};
+
+// The first reference to a fresh object is taken and dropped on another thread. The object is queued to its
+// owner and released when the owner merges its queue.
+void FirstReferenceOnOtherThread() {
+  Node* node = new Node();
+  std::thread([node] { IntrusivePtr<Node> ptr(node); }).join();
+  assert(live.load() == 1);
+  BiasedRefCount::MergeQueued();
+  assert(live.load() == 0);
+}
+
+// Same, but the owner has already exited, so the other thread merges and releases the object itself.
+void FirstReferenceAfterOwnerExit() {
+  Node* node = nullptr;
+  std::thread([&node] { node = new Node(); }).join();
+  std::thread([node] { IntrusivePtr<Node> ptr(node); }).join();
+  assert(live.load() == 0);
+}
+
+// A reference taken and dropped elsewhere while the owner holds one must not release the object.
+void OwnerHoldsReference() {
+  IntrusivePtr<Node> ptr = MakeIntrusive<Node>();
+  std::thread([&ptr] { IntrusivePtr<Node> copy(ptr); }).join();
+  BiasedRefCount::MergeQueued();
+  assert(live.load() == 1 && ptr.UseCount() == 1);
+  ptr.Reset();
+  assert(live.load() == 0);
+}
+
+}  // namespace
+
+int main() {
+  FirstReferenceOnOtherThread();
+  FirstReferenceAfterOwnerExit();
+  OwnerHoldsReference();
+  std::puts("OK");
+}
@@ -0,0 +1,286 @@
+#ifndef COUNTER_ALLOCATOR_H
+#define COUNTER_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+struct SlabStats {
+  std::size_t live_blocks = 0;
+  std::size_t slab_count = 0;
+};
+
+// Pool of fixed-size blocks carved from large slabs. Every thread keeps a small cache of free blocks and
+// refills or drains it in batches under the pool mutex, so allocation and deallocation normally touch only
+// thread-local memory. Slabs are never returned to the system, and the pool itself is leaked on purpose so
+// that blocks released during static destruction still have a valid home.
+template <std::size_t BlockSize>
+class SlabPool {
+ private:
+  static constexpr std::size_t kSlabSize = 16384;
+  static constexpr std::size_t kBatchSize = 32;
+  static constexpr std::size_t kMaxCached = 2 * kBatchSize;
+
+  static_assert(BlockSize >= sizeof(void*) && BlockSize % alignof(void*) == 0);
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  enum class CacheState { kUnregistered, kActive, kExited };
+
+  // Trivially destructible, so its storage stays usable for the whole lifetime of the thread. The count is
+  // written only by the owner and read by Stats().
+  struct ThreadCache {
+    FreeBlock* head;
+    std::atomic<std::size_t> count;
+    CacheState state;
+    ThreadCache* next_cache;
+    ThreadCache* prev_cache;
+  };
+
+  // Returns the cache's blocks to the pool when its thread exits.
+  struct CacheFlusher {
+    ThreadCache* cache;
+
+    ~CacheFlusher() {
+      Instance().Unregister(*cache);
+    }
+  };
+
+  std::mutex mutex_;
+  FreeBlock* free_list_ = nullptr;
+  ThreadCache* caches_ = nullptr;
+  std::size_t handed_out_ = 0;
+  std::size_t slab_count_ = 0;
+
+  SlabPool() = default;
+
+  static ThreadCache& LocalCache() {
+    thread_local ThreadCache cache{};
+    return cache;
+  }
+
+  static std::size_t Count(const ThreadCache& cache) {
+    return cache.count.load(std::memory_order_relaxed);
+  }
+
+  static void SetCount(ThreadCache& cache, std::size_t count) {
+    cache.count.store(count, std::memory_order_relaxed);
+  }
+
+  FreeBlock* PopGlobal() {
+    if (free_list_ == nullptr) {
+      auto* slab = static_cast<char*>(::operator new(kSlabSize));
+      for (std::size_t offset = 0; offset + BlockSize <= kSlabSize; offset += BlockSize) {
+        auto* block = reinterpret_cast<FreeBlock*>(slab + offset);
+        block->next = free_list_;
+        free_list_ = block;
+      }
+      ++slab_count_;
+    }
+    FreeBlock* block = free_list_;
+    free_list_ = block->next;
+    ++handed_out_;
+    return block;
+  }
+
+  void PushGlobal(FreeBlock* block) {
+    block->next = free_list_;
+    free_list_ = block;
+    --handed_out_;
+  }
+
+  void Register(ThreadCache& cache) {
+    thread_local CacheFlusher flusher{&cache};
+    cache.state = CacheState::kActive;
+    cache.next_cache = caches_;
+    cache.prev_cache = nullptr;
+    if (caches_) {
+      caches_->prev_cache = &cache;
+    }
+    caches_ = &cache;
+  }
+
+  void Unregister(ThreadCache& cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (cache.head) {
+      FreeBlock* block = cache.head;
+      cache.head = block->next;
+      PushGlobal(block);
+    }
+    SetCount(cache, 0);
+    if (cache.prev_cache) {
+      cache.prev_cache->next_cache = cache.next_cache;
+    } else {
+      caches_ = cache.next_cache;
+    }
+    if (cache.next_cache) {
+      cache.next_cache->prev_cache = cache.prev_cache;
+    }
+    cache.state = CacheState::kExited;
+  }
+
+  void* AllocateSlow(ThreadCache& cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cache.state == CacheState::kExited) {
+      return PopGlobal();
+    }
+    if (cache.state == CacheState::kUnregistered) {
+      Register(cache);
+    }
+    for (std::size_t i = 0; i != kBatchSize; ++i) {
+      FreeBlock* block = PopGlobal();
+      block->next = cache.head;
+      cache.head = block;
+    }
+    SetCount(cache, kBatchSize - 1);
+    FreeBlock* block = cache.head;
+    cache.head = block->next;
+    return block;
+  }
+
+  void DeallocateSlow(ThreadCache& cache, FreeBlock* block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cache.state == CacheState::kExited) {
+      PushGlobal(block);
+      return;
+    }
+    if (cache.state == CacheState::kUnregistered) {
+      Register(cache);
+    }
+    std::size_t count = Count(cache);
+    if (count >= kMaxCached) {
+      for (std::size_t i = 0; i != kBatchSize; ++i) {
+        FreeBlock* drained = cache.head;
+        cache.head = drained->next;
+        PushGlobal(drained);
+      }
+      count -= kBatchSize;
+    }
+    block->next = cache.head;
+    cache.head = block;
+    SetCount(cache, count + 1);
+  }
+
+ public:
+  static SlabPool& Instance() {
+    static SlabPool* instance = new SlabPool();
+    return *instance;
+  }
+
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  void* Allocate() {
+    ThreadCache& cache = LocalCache();
+    FreeBlock* block = cache.head;
+    if (block == nullptr) {
+      return AllocateSlow(cache);
+    }
+    cache.head = block->next;
+    SetCount(cache, Count(cache) - 1);
+    return block;
+  }
+
+  void Deallocate(void* ptr) {
+    ThreadCache& cache = LocalCache();
+    auto* block = static_cast<FreeBlock*>(ptr);
+    std::size_t count = Count(cache);
+    if (count >= kMaxCached || cache.state != CacheState::kActive) {
+      DeallocateSlow(cache, block);
+      return;
+    }
+    block->next = cache.head;
+    cache.head = block;
+    SetCount(cache, count + 1);
+  }
+
+  SlabStats Stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t cached = 0;
+    for (ThreadCache* cache = caches_; cache; cache = cache->next_cache) {
+      cached += Count(*cache);
+    }
+    return {handed_out_ - cached, slab_count_};
+  }
+};
+
+// Routes small control blocks to a SlabPool per 16-byte size class and everything else to operator new.
+class CounterAllocator {
+ private:
+  static constexpr std::size_t kGranularity = 16;
+
+ public:
+  static constexpr std::size_t kMaxBlockSize = 64;
+
+  static void* Allocate(std::size_t size) {
+    switch ((size + kGranularity - 1) / kGranularity) {
+      case 0:
+      case 1:
+        return SlabPool<16>::Instance().Allocate();
+      case 2:
+        return SlabPool<32>::Instance().Allocate();
+      case 3:
+        return SlabPool<48>::Instance().Allocate();
+      case 4:
+        return SlabPool<64>::Instance().Allocate();
+      default:
+        return ::operator new(size);
+    }
+  }
+
+  static void Deallocate(void* ptr, std::size_t size) noexcept {
+    switch ((size + kGranularity - 1) / kGranularity) {
+      case 0:
+      case 1:
+        SlabPool<16>::Instance().Deallocate(ptr);
+        break;
+      case 2:
+        SlabPool<32>::Instance().Deallocate(ptr);
+        break;
+      case 3:
+        SlabPool<48>::Instance().Deallocate(ptr);
+        break;
+      case 4:
+        SlabPool<64>::Instance().Deallocate(ptr);
+        break;
+      default:
+        ::operator delete(ptr, size);
+    }
+  }
+
+  // Totals over all size classes. Blocks sitting in thread caches count as free.
+  static SlabStats Stats() {
+    SlabStats result;
+    for (SlabStats stats : {SlabPool<16>::Instance().Stats(), SlabPool<32>::Instance().Stats(),
+                            SlabPool<48>::Instance().Stats(), SlabPool<64>::Instance().Stats()}) {
+      result.live_blocks += stats.live_blocks;
+      result.slab_count += stats.slab_count;
+    }
+    return result;
+  }
+};
+
+// Base for control blocks allocated with plain new: gives them class-level new/delete backed by
+// CounterAllocator. Over-aligned blocks fall back to the global aligned forms.
+struct SlabAllocated {
+  static void* operator new(std::size_t size) {
+    return CounterAllocator::Allocate(size);
+  }
+
+  static void* operator new(std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+  }
+
+  static void operator delete(void* ptr, std::size_t size) noexcept {
+    CounterAllocator::Deallocate(ptr, size);
+  }
+
+  static void operator delete(void* ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    ::operator delete(ptr, size, alignment);
+  }
+};
+
+#endif
@@ -0,0 +1,112 @@
+// g++ -std=c++17 -O2 -pthread shared_ptr/counter_allocator_benchmark.cpp -o counter_allocator_benchmark
+//
+// Construct/destroy churn of separately allocated control blocks: SharedPtr(T*) with slab-allocated counters
+// against std::shared_ptr(T*), whose control block comes from operator new, and the allocators on their own.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "counter_allocator.h"
+#include "shared_ptr.h"
+
+namespace {
+
+constexpr int kIterations = 10'000'000;
+constexpr int kBatch = 100'000;
+constexpr std::size_t kBlockSize = 24;
+
+template <typename F>
+double NanosecondsPerIteration(int iterations, F&& body) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i != iterations; ++i) {
+    body(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+// One at a time, so every block is returned before the next is taken.
+template <typename Ptr>
+double Churn() {
+  return NanosecondsPerIteration(kIterations, [](int i) {
+    Ptr ptr(new int(i));
+    Ptr copy(ptr);
+    asm volatile("" : : "r"(copy.get()) : "memory");
+  });
+}
+
+// Many live at once, which drains and refills the thread caches.
+template <typename Ptr>
+double BatchChurn() {
+  std::vector<Ptr> batch;
+  batch.reserve(kBatch);
+  return NanosecondsPerIteration(kIterations / kBatch, [&](int) {
+           for (int i = 0; i != kBatch; ++i) {
+             batch.emplace_back(new int(i));
+           }
+           batch.clear();
+         }) /
+         kBatch;
+}
+
+template <typename Allocate, typename Deallocate>
+double BatchAllocator(Allocate&& allocate, Deallocate&& deallocate) {
+  std::vector<void*> blocks(kBatch);
+  return NanosecondsPerIteration(kIterations / kBatch, [&](int) {
+           for (void*& block : blocks) {
+             block = allocate();
+           }
+           for (void* block : blocks) {
+             deallocate(block);
+           }
+         }) /
+         kBatch;
+}
+
+template <typename F>
+double Threaded(int threads, F&& run) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t != threads; ++t) {
+    workers.emplace_back(run);
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         (static_cast<double>(kIterations) * threads);
+}
+
+// Adapts SharedPtr to the std::shared_ptr spelling used above.
+template <typename RefCount>
+struct SlabSharedPtr : SharedPtr<int, RefCount> {
+  using SharedPtr<int, RefCount>::SharedPtr;
+
+  int* get() const {  // NOLINT
+    return this->Get();
+  }
+};
+
+using PlainSharedPtr = SlabSharedPtr<SingleThreadRefCount>;
+// Atomic counts, like std::shared_ptr.
+using AtomicSharedPtr = SlabSharedPtr<AtomicRefCount>;
+
+}  // namespace
+
+int main() {
+  std::printf("churn, one at a time: SharedPtr %6.2f ns, atomic SharedPtr %6.2f ns, std::shared_ptr %6.2f ns\n",
+              Churn<PlainSharedPtr>(), Churn<AtomicSharedPtr>(), Churn<std::shared_ptr<int>>());
+  std::printf("churn, %d live:   SharedPtr %6.2f ns, atomic SharedPtr %6.2f ns, std::shared_ptr %6.2f ns\n", kBatch,
+              BatchChurn<PlainSharedPtr>(), BatchChurn<AtomicSharedPtr>(), BatchChurn<std::shared_ptr<int>>());
+  std::printf("%zu-byte blocks, %d live: CounterAllocator %6.2f ns, operator new %6.2f ns\n", kBlockSize, kBatch,
+              BatchAllocator([] { return CounterAllocator::Allocate(kBlockSize); },
+                             [](void* block) { CounterAllocator::Deallocate(block, kBlockSize); }),
+              BatchAllocator([] { return ::operator new(kBlockSize); },
+                             [](void* block) { ::operator delete(block, kBlockSize); }));
+  std::printf("churn, 4 threads:     atomic SharedPtr %6.2f ns, std::shared_ptr %6.2f ns\n",
+              Threaded(4, [] { Churn<AtomicSharedPtr>(); }), Threaded(4, [] { Churn<std::shared_ptr<int>>(); }));
+  const SlabStats stats = CounterAllocator::Stats();
+  std::printf("after the run: %zu live blocks, %zu slabs\n", stats.live_blocks, stats.slab_count);
+}
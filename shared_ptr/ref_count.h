@@ -0,0 +1,353 @@
+#ifndef REF_COUNT_H
+#define REF_COUNT_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Reference count policies for SharedPtr/WeakPtr. Decrement() reports whether the count dropped to zero, and
+// IncrementIfNotZero() is the only way to resurrect a strong reference from a weak one.
+
+// Plain counter for objects that never cross threads.
+class SingleThreadRefCount {
+ private:
+  int count_;
+
+ public:
+  explicit SingleThreadRefCount(int count) noexcept : count_{count} {
+  }
+
+  void Increment() noexcept {
+    ++count_;
+  }
+
+  bool Decrement() noexcept {
+    return --count_ == 0;
+  }
+
+  bool IncrementIfNotZero() noexcept {
+    if (count_ == 0) {
+      return false;
+    }
+    ++count_;
+    return true;
+  }
+
+  int Load() const noexcept {
+    return count_;
+  }
+};
+
+// Increments are relaxed: a new reference can only be made from an existing one, so no ordering is needed.
+// The final decrement must see every write made through other references before the object is destroyed,
+// so decrements are acquire-release.
+class AtomicRefCount {
+ private:
+  std::atomic<int> count_;
+
+ public:
+  explicit AtomicRefCount(int count) noexcept : count_{count} {
+  }
+
+  void Increment() noexcept {
+    count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool Decrement() noexcept {
+    return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  bool IncrementIfNotZero() noexcept {
+    int count = count_.load(std::memory_order_relaxed);
+    while (count != 0) {
+      if (count_.compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int Load() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+  }
+};
+
+// Biased counting for objects that are mostly referenced from the thread that created them (the owner). The
+// owner updates a local count with plain loads and stores; other threads update a shared atomic count. When
+// the local count drops to zero the owner merges it into the shared one, and from then on every thread uses
+// the shared count. A reference handed to another thread and released there can drive the shared count below
+// zero while the owner still holds local references, or to zero while the owner holds none; such objects are
+// queued to the owner, which merges them on its next counting operation, in MergeQueued(), or when it exits. If
+// the merge finds no references left, the callback installed with SetDeferredRelease() releases the object,
+// since no Decrement() will report it.
+class BiasedRefCount {
+ private:
+  struct ThreadState {
+    std::mutex mutex_;
+    std::vector<BiasedRefCount*> queue_;
+    std::atomic<bool> has_queued_{false};
+    bool alive_ = false;
+    ThreadState* next_free_ = nullptr;
+  };
+
+  // Thread states are recycled rather than freed, because counts keep pointing at their owner's state. A
+  // thread that picks up a recycled state becomes the owner of whatever its previous thread left unmerged.
+  struct Registry {
+    std::mutex mutex_;
+    ThreadState* free_ = nullptr;
+
+    static Registry& Instance() {
+      static auto* registry = new Registry();
+      return *registry;
+    }
+  };
+
+  // Trivially destructible so it can still be read after the thread has started tearing down.
+  struct LocalState {
+    ThreadState* state;
+    bool exited;
+  };
+
+  struct StateReleaser {
+    ~StateReleaser() {
+      LocalState& local = Local();
+      ThreadState* state = local.state;
+      local.state = nullptr;
+      local.exited = true;
+      while (true) {
+        std::vector<BiasedRefCount*> queue;
+        {
+          std::lock_guard<std::mutex> lock(state->mutex_);
+          if (state->queue_.empty()) {
+            state->alive_ = false;
+            break;
+          }
+          queue.swap(state->queue_);
+        }
+        MergeAll(queue);
+      }
+      Registry& registry = Registry::Instance();
+      std::lock_guard<std::mutex> lock(registry.mutex_);
+      state->next_free_ = registry.free_;
+      registry.free_ = state;
+    }
+  };
+
+  // shared_ holds count * kOne plus the flag bits.
+  static constexpr int64_t kMerged = 1;
+  static constexpr int64_t kQueued = 2;
+  static constexpr int64_t kOne = 4;
+  static constexpr int kLocalMerged = -1;
+
+  ThreadState* owner_;
+  std::atomic<int> local_;
+  std::atomic<int64_t> shared_;
+  void (*release_)(void*) = nullptr;
+  void* context_ = nullptr;
+
+  static int64_t CountOf(int64_t shared) {
+    return (shared - (shared & (kOne - 1))) / kOne;
+  }
+
+  static LocalState& Local() {
+    thread_local LocalState local{};
+    return local;
+  }
+
+  static ThreadState* CurrentState() {
+    LocalState& local = Local();
+    if (local.state == nullptr && !local.exited) {
+      Claim(local);
+    }
+    return local.state;
+  }
+
+  static void Claim(LocalState& local) {
+    Registry& registry = Registry::Instance();
+    ThreadState* state;
+    {
+      std::lock_guard<std::mutex> lock(registry.mutex_);
+      state = registry.free_;
+      if (state) {
+        registry.free_ = state->next_free_;
+      }
+    }
+    if (state == nullptr) {
+      state = new ThreadState();
+    }
+    {
+      std::lock_guard<std::mutex> lock(state->mutex_);
+      state->alive_ = true;
+    }
+    thread_local StateReleaser releaser;
+    local.state = state;
+  }
+
+  static void MergeAll(const std::vector<BiasedRefCount*>& queue) {
+    for (BiasedRefCount* count : queue) {
+      if (count->Merge() && count->release_) {
+        count->release_(count->context_);
+      }
+    }
+  }
+
+  static void Drain(ThreadState* state) {
+    std::vector<BiasedRefCount*> queue;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex_);
+      queue.swap(state->queue_);
+      state->has_queued_.store(false, std::memory_order_relaxed);
+    }
+    MergeAll(queue);
+  }
+
+  bool IsOwner(ThreadState* current) const {
+    if (current == nullptr || owner_ != current) {
+      return false;
+    }
+    if (current->has_queued_.load(std::memory_order_relaxed)) {
+      Drain(current);
+    }
+    return true;
+  }
+
+  // Folds the local count into the shared one. Returns true if no references remain.
+  bool Merge() {
+    const int local = local_.load(std::memory_order_relaxed);
+    local_.store(kLocalMerged, std::memory_order_relaxed);
+    const int64_t delta = local * kOne + kMerged;
+    return CountOf(shared_.fetch_add(delta, std::memory_order_acq_rel) + delta) == 0;
+  }
+
+  // The owner's local count has just reached zero. A queued object is left for the queue to merge.
+  bool MergeZeroLocal() {
+    int64_t shared = shared_.load(std::memory_order_relaxed);
+    while (!(shared & kQueued)) {
+      if (shared_.compare_exchange_weak(shared, shared | kMerged, std::memory_order_acq_rel,
+                                        std::memory_order_relaxed)) {
+        local_.store(kLocalMerged, std::memory_order_relaxed);
+        return CountOf(shared) == 0;
+      }
+    }
+    return false;
+  }
+
+  // An unmerged object is queued once the shared count goes negative, or reaches zero while the owner holds no
+  // local references either (an object created with a count of zero and first referenced on another thread);
+  // otherwise nobody would ever see its total drop to zero. If the owner's local count reaches zero concurrently,
+  // whichever of this CAS and MergeZeroLocal() wins decides who releases the object.
+  bool DecrementShared() {
+    int64_t shared = shared_.load(std::memory_order_relaxed);
+    int64_t next;
+    do {
+      next = shared - kOne;
+      if (!(shared & (kMerged | kQueued)) &&
+          (CountOf(next) < 0 || (CountOf(next) == 0 && local_.load(std::memory_order_relaxed) == 0))) {
+        next |= kQueued;
+      }
+    } while (!shared_.compare_exchange_weak(shared, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+    if (next & kMerged) {
+      return CountOf(next) == 0;
+    }
+    if ((next & kQueued) && !(shared & kQueued)) {
+      return Enqueue();
+    }
+    return false;
+  }
+
+  // Hands the object to its owner. If the owner has exited, nobody else can touch the local count, so it is
+  // merged right here; the state lock keeps a new thread from adopting the state meanwhile.
+  bool Enqueue() {
+    std::lock_guard<std::mutex> lock(owner_->mutex_);
+    if (owner_->alive_) {
+      owner_->queue_.push_back(this);
+      owner_->has_queued_.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    return Merge();
+  }
+
+ public:
+  explicit BiasedRefCount(int count) : owner_{CurrentState()} {
+    if (owner_) {
+      local_.store(count, std::memory_order_relaxed);
+      shared_.store(0, std::memory_order_relaxed);
+    } else {
+      local_.store(kLocalMerged, std::memory_order_relaxed);
+      shared_.store(count * kOne + kMerged, std::memory_order_relaxed);
+    }
+  }
+
+  BiasedRefCount(const BiasedRefCount&) = delete;
+  BiasedRefCount& operator=(const BiasedRefCount&) = delete;
+
+  void SetDeferredRelease(void (*release)(void*), void* context) noexcept {
+    release_ = release;
+    context_ = context;
+  }
+
+  void Increment() {
+    if (IsOwner(CurrentState())) {
+      const int local = local_.load(std::memory_order_relaxed);
+      if (local != kLocalMerged) {
+        local_.store(local + 1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    shared_.fetch_add(kOne, std::memory_order_relaxed);
+  }
+
+  bool Decrement() {
+    if (IsOwner(CurrentState())) {
+      const int local = local_.load(std::memory_order_relaxed);
+      if (local > 0) {
+        local_.store(local - 1, std::memory_order_relaxed);
+        return local == 1 && MergeZeroLocal();
+      }
+    }
+    return DecrementShared();
+  }
+
+  bool IncrementIfNotZero() {
+    if (IsOwner(CurrentState())) {
+      const int local = local_.load(std::memory_order_relaxed);
+      if (local > 0) {
+        local_.store(local + 1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    int64_t shared = shared_.load(std::memory_order_relaxed);
+    while (!((shared & kMerged) && CountOf(shared) == 0)) {
+      if (shared_.compare_exchange_weak(shared, shared + kOne, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int Load() const noexcept {
+    const int local = local_.load(std::memory_order_relaxed);
+    return (local == kLocalMerged ? 0 : local) + static_cast<int>(CountOf(shared_.load(std::memory_order_relaxed)));
+  }
+
+  // Merges every object queued to the calling thread. Owners that rarely touch their counts can call this at
+  // convenient points to release objects whose last reference was dropped elsewhere.
+  static void MergeQueued() {
+    if (ThreadState* state = CurrentState()) {
+      Drain(state);
+    }
+  }
+};
+
+// Policies whose count can reach zero outside Decrement() need a callback from their owner.
+template <typename RefCount, typename = void>
+struct HasDeferredRelease : std::false_type {};
+
+template <typename RefCount>
+struct HasDeferredRelease<RefCount, std::void_t<decltype(&RefCount::SetDeferredRelease)>> : std::true_type {};
+
+#endif
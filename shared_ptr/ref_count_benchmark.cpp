@@ -0,0 +1,117 @@
+// g++ -std=c++17 -O2 -pthread shared_ptr/ref_count_benchmark.cpp -o ref_count_benchmark
+//
+// Cost of copying and destroying a SharedPtr, and of promoting a WeakPtr, under each reference count policy.
+// The contended runs share one object between several threads; the cross-thread runs exercise BiasedRefCount
+// on threads other than the owner and the hand-off of last references to another thread.
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "shared_ptr.h"
+
+namespace {
+
+constexpr int kIterations = 20'000'000;
+
+template <typename F>
+double NanosecondsPerIteration(int iterations, F&& body) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i != iterations; ++i) {
+    body();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+template <typename RefCount>
+double CopyDestroy() {
+  auto ptr = MakeShared<int, RefCount>(1);
+  return NanosecondsPerIteration(kIterations, [&] {
+    SharedPtr<int, RefCount> copy(ptr);
+    asm volatile("" : : "r"(copy.Get()) : "memory");
+  });
+}
+
+template <typename RefCount>
+double WeakLock() {
+  auto ptr = MakeShared<int, RefCount>(1);
+  WeakPtr<int, RefCount> weak(ptr);
+  return NanosecondsPerIteration(kIterations, [&] {
+    auto locked = weak.Lock();
+    asm volatile("" : : "r"(locked.Get()) : "memory");
+  });
+}
+
+// Wall time per operation, summed over threads that all copy and destroy the same object.
+template <typename RefCount>
+double ContendedCopyDestroy(int threads) {
+  auto ptr = MakeShared<int, RefCount>(1);
+  const int iterations = kIterations / threads;
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t != threads; ++t) {
+    workers.emplace_back([&] {
+      NanosecondsPerIteration(iterations, [&] {
+        SharedPtr<int, RefCount> copy(ptr);
+        asm volatile("" : : "r"(copy.Get()) : "memory");
+      });
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / (static_cast<double>(iterations) * threads);
+}
+
+// Copies and destroys an object created by another thread, which takes BiasedRefCount's shared path.
+template <typename RefCount>
+double NonOwnerCopyDestroy() {
+  auto ptr = MakeShared<int, RefCount>(1);
+  double result = 0;
+  std::thread([&] {
+    result = NanosecondsPerIteration(kIterations, [&] {
+      SharedPtr<int, RefCount> copy(ptr);
+      asm volatile("" : : "r"(copy.Get()) : "memory");
+    });
+  }).join();
+  return result;
+}
+
+// The owner creates objects and another thread drops their last references. For BiasedRefCount this queues
+// every object to the owner, which merges and frees them.
+template <typename RefCount>
+double HandOff() {
+  constexpr int kObjects = 1'000'000;
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<SharedPtr<int, RefCount>> objects;
+  objects.reserve(kObjects);
+  for (int i = 0; i != kObjects; ++i) {
+    objects.push_back(MakeShared<int, RefCount>(i));
+  }
+  std::thread([&objects] { objects.clear(); }).join();
+  if constexpr (HasDeferredRelease<RefCount>::value) {
+    RefCount::MergeQueued();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kObjects;
+}
+
+}  // namespace
+
+int main() {
+  std::printf("copy+destroy, one thread:  SingleThreadRefCount %6.2f ns, AtomicRefCount %6.2f ns, "
+              "BiasedRefCount %6.2f ns\n",
+              CopyDestroy<SingleThreadRefCount>(), CopyDestroy<AtomicRefCount>(), CopyDestroy<BiasedRefCount>());
+  std::printf("WeakPtr::Lock, one thread: SingleThreadRefCount %6.2f ns, AtomicRefCount %6.2f ns\n",
+              WeakLock<SingleThreadRefCount>(), WeakLock<AtomicRefCount>());
+  const int cores = static_cast<int>(std::thread::hardware_concurrency());
+  for (int threads : {2, 4, 8}) {
+    std::printf("copy+destroy, %d threads on one object (%d cores): AtomicRefCount %6.2f ns\n", threads, cores,
+                ContendedCopyDestroy<AtomicRefCount>(threads));
+  }
+  std::printf("copy+destroy off the owner thread: AtomicRefCount %6.2f ns, BiasedRefCount %6.2f ns\n",
+              NonOwnerCopyDestroy<AtomicRefCount>(), NonOwnerCopyDestroy<BiasedRefCount>());
+  std::printf("create, drop last reference on another thread: AtomicRefCount %6.2f ns, BiasedRefCount %6.2f ns\n",
+              HandOff<AtomicRefCount>(), HandOff<BiasedRefCount>());
+}
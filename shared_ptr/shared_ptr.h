@@ -2,7 +2,15 @@
 #define SHARED_PTR_H
 #define WEAK_PTR_IMPLEMENTED
 
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "counter_allocator.h"
+#include "ref_count.h"
+#include "tracking.h"
 
 class BadWeakPtr : public std::runtime_error {
  public:
@@ -10,44 +18,249 @@ class BadWeakPtr : public std::runtime_error {
   }
 };
 
-template <typename T>
+template <typename T, typename RefCount = SingleThreadRefCount>
+class SharedPtr;
+
+template <typename T, typename RefCount = SingleThreadRefCount>
 class WeakPtr;
 
+template <typename T, typename RefCount = SingleThreadRefCount>
+class EnableSharedFromThis;
+
+// Control block shared by all pointers to one object. The weak count includes one extra reference held
+// collectively by the strong owners, so the block outlives the object even if the object's destructor drops
+// the last WeakPtr to itself.
+template <typename RefCount = SingleThreadRefCount>
 struct Counter {
-  int strong_count_;
-  int weak_count_;
+  RefCount strong_count_;
+  RefCount weak_count_;
+
+  Counter() : strong_count_{1}, weak_count_{1} {
+    if constexpr (HasDeferredRelease<RefCount>::value) {
+      strong_count_.SetDeferredRelease(
+          [](void* counter) {
+            static_cast<Counter*>(counter)->Expire();
+          },
+          this);
+      weak_count_.SetDeferredRelease([](void* counter) { static_cast<Counter*>(counter)->DestroyCounter(); }, this);
+    }
+  }
+
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  virtual ~Counter() = default;
+
+  virtual void DestroyObject() noexcept = 0;
+
+  virtual void DestroyCounter() noexcept {
+    delete this;
+  }
+
+  void AddStrong() {
+    strong_count_.Increment();
+  }
+
+  bool TryAddStrong() {
+    return strong_count_.IncrementIfNotZero();
+  }
+
+  void AddWeak() {
+    weak_count_.Increment();
+  }
+
+  void ReleaseStrong() {
+    if (strong_count_.Decrement()) {
+      Expire();
+    }
+  }
+
+  // The last strong reference is gone.
+  void Expire() noexcept {
+    UntrackCounter(this);
+    DestroyObject();
+    ReleaseWeak();
+  }
+
+  void ReleaseWeak() {
+    if (weak_count_.Decrement()) {
+      DestroyCounter();
+    }
+  }
+};
+
+template <typename T, typename RefCount>
+struct PointerCounter : Counter<RefCount>, SlabAllocated {
+  T* data_;
+
+  explicit PointerCounter(T* ptr) : data_{ptr} {
+  }
+
+  void DestroyObject() noexcept override {
+    delete data_;
+  }
+};
+
+template <typename T, typename Deleter, typename RefCount>
+struct DeleterCounter : Counter<RefCount>, SlabAllocated {
+  T* data_;
+  [[no_unique_address]] Deleter deleter_;
+
+  DeleterCounter(T* ptr, Deleter deleter) : data_{ptr}, deleter_{std::move(deleter)} {
+  }
+
+  void DestroyObject() noexcept override {
+    deleter_(data_);
+  }
+};
+
+// Object and counter in a single allocation, used by MakeShared.
+template <typename T, typename RefCount>
+struct InplaceCounter : Counter<RefCount> {
+  alignas(T) unsigned char storage_[sizeof(T)];
+
+  template <typename... Args>
+  explicit InplaceCounter(Args&&... args) {
+    new (storage_) T(std::forward<Args>(args)...);
+  }
 
-  Counter() : strong_count_{0}, weak_count_{0} {
+  T* Get() {
+    return std::launder(reinterpret_cast<T*>(storage_));
   }
 
-  ~Counter() = default;
+  void DestroyObject() noexcept override {
+    Get()->~T();
+  }
 };
 
-template <typename T>
+// Object and counter in a single block obtained from a user allocator, used by AllocateShared. The block is
+// returned to a copy of that allocator once the last weak reference is gone.
+template <typename T, typename Allocator, typename RefCount>
+struct AllocatorCounter : Counter<RefCount> {
+  using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<AllocatorCounter>;
+  using ObjectAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+  [[no_unique_address]] BlockAllocator allocator_;
+  alignas(T) unsigned char storage_[sizeof(T)];
+
+  template <typename... Args>
+  explicit AllocatorCounter(const BlockAllocator& allocator, Args&&... args) : allocator_{allocator} {
+    ObjectAllocator object_allocator(allocator_);
+    std::allocator_traits<ObjectAllocator>::construct(object_allocator, Get(), std::forward<Args>(args)...);
+  }
+
+  T* Get() {
+    return std::launder(reinterpret_cast<T*>(storage_));
+  }
+
+  void DestroyObject() noexcept override {
+    ObjectAllocator object_allocator(allocator_);
+    std::allocator_traits<ObjectAllocator>::destroy(object_allocator, Get());
+  }
+
+  void DestroyCounter() noexcept override {
+    BlockAllocator allocator(allocator_);
+    this->~AllocatorCounter();
+    std::allocator_traits<BlockAllocator>::deallocate(allocator, this, 1);
+  }
+};
+
+template <typename T, typename RefCount>
 class SharedPtr {
  private:
   T* data_;
-  Counter* counter_;
+  Counter<RefCount>* counter_;
+
+  SharedPtr(T* ptr, Counter<RefCount>* counter) : data_{ptr}, counter_{counter} {
+    TrackSlot(&counter_);
+  }
+
+  void Release() {
+    if (counter_) {
+      counter_->ReleaseStrong();
+    }
+  }
+
+  // Called by every owner that creates a new counter: registers it with the tracker and lets objects derived
+  // from EnableSharedFromThis learn about the block that owns them.
+  void AdoptCounter() {
+    TrackCounter(counter_, data_, [](const void* counter) {
+      return static_cast<const Counter<RefCount>*>(counter)->strong_count_.Load();
+    });
+    AttachToBase(const_cast<std::remove_cv_t<T>*>(data_));
+  }
+
+  template <typename U>
+  void AttachToBase(EnableSharedFromThis<U, RefCount>* base) {
+    if (base && base->weak_this_.Expired()) {
+      base->weak_this_ = SharedPtr<U, RefCount>(*this, static_cast<U*>(base));
+    }
+  }
+
+  void AttachToBase(...) {
+  }
+
+  friend class WeakPtr<T, RefCount>;
+
+  template <typename U, typename R, typename... Args>
+  friend SharedPtr<U, R> MakeShared(Args&&... args);
+
+  template <typename U, typename R, typename Allocator, typename... Args>
+  friend SharedPtr<U, R> AllocateShared(const Allocator& allocator, Args&&... args);
 
  public:
   SharedPtr() : data_{nullptr}, counter_{nullptr} {
+    TrackSlot(&counter_);
   }
 
   SharedPtr(T* ptr) {  // NOLINT
     data_ = ptr;
     counter_ = nullptr;
     if (ptr) {
-      counter_ = new Counter();
-      ++counter_->strong_count_;
+      try {
+        counter_ = new PointerCounter<T, RefCount>(ptr);
+      } catch (...) {
+        delete ptr;
+        throw;
+      }
+      AdoptCounter();
+    }
+    TrackSlot(&counter_);
+  }
+
+  // The deleter is called as deleter(ptr) when the last strong reference goes away.
+  template <typename Deleter, typename = std::enable_if_t<std::is_invocable_v<Deleter&, T*>>>
+  SharedPtr(T* ptr, Deleter deleter) {
+    data_ = ptr;
+    counter_ = nullptr;
+    if (ptr) {
+      try {
+        counter_ = new DeleterCounter<T, Deleter, RefCount>(ptr, deleter);
+      } catch (...) {
+        deleter(ptr);
+        throw;
+      }
+      AdoptCounter();
+    }
+    TrackSlot(&counter_);
+  }
+
+  // Aliasing constructor: shares ownership with other but points at ptr, usually a member of *other.
+  template <typename U>
+  SharedPtr(const SharedPtr<U, RefCount>& other, T* ptr) : data_{ptr}, counter_{other.GetCounter()} {
+    if (counter_) {
+      counter_->AddStrong();
     }
+    TrackSlot(&counter_);
   }
 
   SharedPtr(const SharedPtr& other) {
     data_ = other.data_;
     counter_ = other.counter_;
-    if (data_) {
-      ++counter_->strong_count_;
+    if (counter_) {
+      counter_->AddStrong();
     }
+    TrackSlot(&counter_);
   }
 
   SharedPtr& operator=(const SharedPtr& other) {
@@ -55,21 +268,13 @@ class SharedPtr {
       return *this;
     }
 
-    if (counter_) {
-      --counter_->strong_count_;
-      if (counter_->strong_count_ == 0) {
-        delete data_;
-        if (counter_->weak_count_ == 0) {
-          delete counter_;
-        }
-      }
+    if (other.counter_) {
+      other.counter_->AddStrong();
     }
+    Release();
 
     data_ = other.data_;
     counter_ = other.counter_;
-    if (data_) {
-      ++counter_->strong_count_;
-    }
     return *this;
   }
 
@@ -79,6 +284,7 @@ class SharedPtr {
 
     counter_ = other.counter_;
     other.counter_ = nullptr;
+    TrackSlot(&counter_);
   }
 
   SharedPtr& operator=(SharedPtr&& other) noexcept {
@@ -86,15 +292,7 @@ class SharedPtr {
       return *this;
     }
 
-    if (counter_) {
-      --counter_->strong_count_;
-      if (counter_->strong_count_ == 0) {
-        delete data_;
-        if (counter_->weak_count_ == 0) {
-          delete counter_;
-        }
-      }
-    }
+    Release();
     data_ = other.data_;
     counter_ = other.counter_;
     other.data_ = nullptr;
@@ -102,48 +300,32 @@ class SharedPtr {
     return *this;
   }
 
-  SharedPtr(const WeakPtr<T>& weak) {  // NOLINT
-    if (weak.Expired()) {
-      throw BadWeakPtr{};
-    }
+  SharedPtr(const WeakPtr<T, RefCount>& weak) {  // NOLINT
     data_ = weak.GetWeak();
     counter_ = weak.GetCounterWeak();
-    ++counter_->strong_count_;
+    if (counter_ == nullptr || !counter_->TryAddStrong()) {
+      throw BadWeakPtr{};
+    }
+    TrackSlot(&counter_);
   }
 
   ~SharedPtr() {
-    if (counter_) {
-      --counter_->strong_count_;
-      if (counter_->strong_count_ == 0) {
-        delete data_;
-        data_ = nullptr;
-        if (counter_->weak_count_ == 0) {
-          delete counter_;
-          counter_ = nullptr;
-        }
-      }
-    }
+    UntrackSlot(&counter_);
+    Release();
+    data_ = nullptr;
+    counter_ = nullptr;
   }
 
   void Reset(T* ptr = nullptr) {
-    if (counter_) {
-      --counter_->strong_count_;
-      if (counter_->strong_count_ == 0) {
-        delete data_;
-        if (counter_->weak_count_ == 0) {
-          delete counter_;
-        }
-      }
-    }
-    data_ = ptr;
-    counter_ = nullptr;
-    if (data_) {
-      counter_ = new Counter();
-      ++counter_->strong_count_;
-    }
+    SharedPtr(ptr).Swap(*this);
   }
 
-  void Swap(SharedPtr<T>& other) {
+  template <typename Deleter>
+  void Reset(T* ptr, Deleter deleter) {
+    SharedPtr(ptr, std::move(deleter)).Swap(*this);
+  }
+
+  void Swap(SharedPtr& other) {
     std::swap(data_, other.data_);
     std::swap(counter_, other.counter_);
   }
@@ -154,7 +336,7 @@ class SharedPtr {
 
   int UseCount() const {
     if (counter_) {
-      return counter_->strong_count_;
+      return counter_->strong_count_.Load();
     }
     return 0;
   }
@@ -171,18 +353,22 @@ class SharedPtr {
     return static_cast<bool>(data_);
   }
 
-  Counter* GetCounter() const {
+  Counter<RefCount>* GetCounter() const {
     return counter_;
   }
-
-  // friend class WeakPtr<T>;
 };
 
-template <typename T>
+template <typename T, typename RefCount>
 class WeakPtr {
  private:
   T* data_;
-  Counter* counter_;
+  Counter<RefCount>* counter_;
+
+  void Release() {
+    if (counter_) {
+      counter_->ReleaseWeak();
+    }
+  }
 
  public:
   WeakPtr() : data_{nullptr}, counter_{nullptr} {
@@ -191,29 +377,23 @@ class WeakPtr {
   WeakPtr(const WeakPtr& other) {
     data_ = other.data_;
     counter_ = other.counter_;
-    if (data_) {
-      ++counter_->weak_count_;
+    if (counter_) {
+      counter_->AddWeak();
     }
   }
 
-  WeakPtr& operator=(WeakPtr& other) {
+  WeakPtr& operator=(const WeakPtr& other) {
     if (this == &other) {
       return *this;
     }
 
-    if (counter_) {
-      --counter_->weak_count_;
-      if (counter_->weak_count_ == 0 && counter_->strong_count_ == 0) {
-        delete counter_;
-        counter_ = nullptr;
-      }
+    if (other.counter_) {
+      other.counter_->AddWeak();
     }
+    Release();
 
     data_ = other.data_;
     counter_ = other.counter_;
-    if (data_) {
-      ++counter_->weak_count_;
-    }
     return *this;
   }
 
@@ -230,14 +410,7 @@ class WeakPtr {
       return *this;
     }
 
-    if (counter_) {
-      --counter_->weak_count_;
-      if (counter_->weak_count_ == 0 && counter_->strong_count_ == 0) {
-        delete counter_;
-        counter_ = nullptr;
-      }
-    }
-
+    Release();
     data_ = other.data_;
     counter_ = other.counter_;
     other.data_ = nullptr;
@@ -245,71 +418,119 @@ class WeakPtr {
     return *this;
   }
 
-  WeakPtr(const SharedPtr<T>& shared) {  // NOLINT
+  WeakPtr(const SharedPtr<T, RefCount>& shared) {  // NOLINT
     data_ = shared.Get();
     counter_ = shared.GetCounter();
-    if (data_) {
-      ++counter_->weak_count_;
+    if (counter_) {
+      counter_->AddWeak();
     }
   }
 
   ~WeakPtr() {
-    if (counter_) {
-      --counter_->weak_count_;
-      if (counter_->weak_count_ == 0 && counter_->strong_count_ == 0) {
-        delete counter_;
-        counter_ = nullptr;
-      }
-    }
+    Release();
+    data_ = nullptr;
+    counter_ = nullptr;
   }
 
-  void Swap(WeakPtr<T>& other) {
+  void Swap(WeakPtr& other) {
     std::swap(data_, other.data_);
     std::swap(counter_, other.counter_);
   }
 
   void Reset() {
-    if (counter_) {
-      --counter_->weak_count_;
-      if (counter_->weak_count_ == 0 && counter_->strong_count_ == 0) {
-        delete counter_;
-        counter_ = nullptr;
-      }
-    }
+    Release();
     data_ = nullptr;
     counter_ = nullptr;
   }
 
   int UseCount() const {
     if (counter_) {
-      return counter_->strong_count_;
+      return counter_->strong_count_.Load();
     }
     return 0;
   }
 
   bool Expired() const {
-    return counter_ == nullptr || counter_->strong_count_ == 0;
+    return counter_ == nullptr || counter_->strong_count_.Load() == 0;
   }
 
-  SharedPtr<T> Lock() const {
-    if (Expired()) {
-      return SharedPtr<T>();
+  SharedPtr<T, RefCount> Lock() const {
+    if (counter_ == nullptr || !counter_->TryAddStrong()) {
+      return SharedPtr<T, RefCount>();
     }
-    return SharedPtr<T>(*this);
+    return SharedPtr<T, RefCount>(data_, counter_);
   }
 
   T* GetWeak() const {
     return data_;
   }
 
-  Counter* GetCounterWeak() const {
+  Counter<RefCount>* GetCounterWeak() const {
     return counter_;
   }
 };
 
-template <typename T, typename... Args>
-SharedPtr<T> MakeShared(Args&&... args) {
-  return SharedPtr<T>(new T(std::forward<Args>(args)...));
+// Objects derived from EnableSharedFromThis can obtain SharedPtrs to themselves once they are owned by one.
+// The base stores only a WeakPtr, so it does not keep the object alive.
+template <typename T, typename RefCount>
+class EnableSharedFromThis {
+ private:
+  mutable WeakPtr<T, RefCount> weak_this_;
+
+  template <typename U, typename R>
+  friend class SharedPtr;
+
+ protected:
+  EnableSharedFromThis() = default;
+
+  EnableSharedFromThis(const EnableSharedFromThis&) {
+  }
+
+  EnableSharedFromThis& operator=(const EnableSharedFromThis&) {
+    return *this;
+  }
+
+  ~EnableSharedFromThis() = default;
+
+ public:
+  // Throws BadWeakPtr if the object is not owned by a SharedPtr.
+  SharedPtr<T, RefCount> SharedFromThis() {
+    return SharedPtr<T, RefCount>(weak_this_);
+  }
+
+  SharedPtr<const T, RefCount> SharedFromThis() const {
+    SharedPtr<T, RefCount> self(weak_this_);
+    return SharedPtr<const T, RefCount>(self, self.Get());
+  }
+
+  WeakPtr<T, RefCount> WeakFromThis() const {
+    return weak_this_;
+  }
+};
+
+template <typename T, typename RefCount = SingleThreadRefCount, typename... Args>
+SharedPtr<T, RefCount> MakeShared(Args&&... args) {
+  auto* counter = new InplaceCounter<T, RefCount>(std::forward<Args>(args)...);
+  SharedPtr<T, RefCount> result(counter->Get(), counter);
+  result.AdoptCounter();
+  return result;
+}
+
+template <typename T, typename RefCount = SingleThreadRefCount, typename Allocator, typename... Args>
+SharedPtr<T, RefCount> AllocateShared(const Allocator& allocator, Args&&... args) {
+  using Block = AllocatorCounter<T, Allocator, RefCount>;
+  using BlockTraits = std::allocator_traits<typename Block::BlockAllocator>;
+  typename Block::BlockAllocator block_allocator(allocator);
+  Block* counter = BlockTraits::allocate(block_allocator, 1);
+  try {
+    new (counter) Block(block_allocator, std::forward<Args>(args)...);
+  } catch (...) {
+    BlockTraits::deallocate(block_allocator, counter, 1);
+    throw;
+  }
+  SharedPtr<T, RefCount> result(counter->Get(), counter);
+  result.AdoptCounter();
+  return result;
 }
 
-#endif
\ No newline at end of file
+#endif
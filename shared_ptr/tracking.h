@@ -0,0 +1,339 @@
+#ifndef SHARED_PTR_TRACKING_H
+#define SHARED_PTR_TRACKING_H
+
+#include <cstddef>
+
+// Leak and cycle tracking for SharedPtr. Define SHARED_PTR_TRACKING for every translation unit to enable it;
+// otherwise the hooks below are empty inline functions and SharedPtr carries no tracking code at all.
+//
+// Every control block is registered with the object's address, size, type name and the id of the call stack
+// that created it. Every SharedPtr registers the address of its counter pointer, so a SharedPtr stored inside
+// a tracked object becomes an edge from that object to the one it owns. Edges are found only by address
+// containment within an object's sizeof(T) bytes, which has two blind spots:
+//  - a SharedPtr kept in heap memory the object owns indirectly, such as the buffer of a Vector, std::vector or
+//    map member, is not attributed to the object. A cycle running through a container is therefore not
+//    reported by FindCycles; its members only show up among the live objects in DumpLive;
+//  - SharedPtr members of a derived class are missed when the object is owned through a base pointer.
+
+#ifdef SHARED_PTR_TRACKING
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define SHARED_PTR_TRACKING_BACKTRACE
+#endif
+
+struct TrackedObject {
+  const void* object = nullptr;
+  std::size_t size = 0;
+  const char* type_name = "";
+  uint64_t stack_id = 0;
+  int use_count = 0;
+};
+
+struct TrackedCycle {
+  std::vector<TrackedObject> objects;
+  // Strong references to cycle members held from outside the cycle. Zero means the cycle is leaked.
+  int external_references = 0;
+};
+
+inline std::string TypeNameFromSignature(const std::string& signature) {
+  std::size_t begin = signature.find("T = ");
+  if (begin == std::string::npos) {
+    return signature;
+  }
+  begin += 4;
+  std::size_t end = signature.find_first_of(";]", begin);
+  return signature.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+// Extracts T from __PRETTY_FUNCTION__, so no RTTI is needed.
+template <typename T>
+const char* TrackedTypeName() {
+  static const std::string name = TypeNameFromSignature(__PRETTY_FUNCTION__);
+  return name.c_str();
+}
+
+class SharedPtrTracker {
+ private:
+  static constexpr int kMaxFrames = 32;
+  static constexpr int kSkippedFrames = 3;
+
+  struct CounterRecord {
+    const void* object;
+    std::size_t size;
+    const char* type_name;
+    uint64_t stack_id;
+    int (*use_count)(const void*);
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<const void*, CounterRecord> counters_;
+  std::map<const void*, const void*> objects_;  // object address -> counter
+  std::unordered_set<const void*> slots_;       // addresses of SharedPtr::counter_
+  std::unordered_map<uint64_t, std::vector<void*>> stacks_;
+
+  SharedPtrTracker() = default;
+
+  TrackedObject Describe(const void* counter, const CounterRecord& record) const {
+    return {record.object, record.size, record.type_name, record.stack_id, record.use_count(counter)};
+  }
+
+  uint64_t CaptureStack() {
+#ifdef SHARED_PTR_TRACKING_BACKTRACE
+    void* frames[kMaxFrames];
+    const int count = backtrace(frames, kMaxFrames);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = std::min(kSkippedFrames, count); i != count; ++i) {
+      hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 0x100000001b3ULL;
+    }
+    auto& stack = stacks_[hash];
+    if (stack.empty()) {
+      stack.assign(frames + std::min(kSkippedFrames, count), frames + count);
+    }
+    return hash;
+#else
+    return 0;
+#endif
+  }
+
+  // Counter whose object contains the given address, or nullptr.
+  const void* Owner(const void* address) const {
+    auto it = objects_.upper_bound(address);
+    if (it == objects_.begin()) {
+      return nullptr;
+    }
+    --it;
+    const auto& record = counters_.at(it->second);
+    const auto* begin = static_cast<const char*>(record.object);
+    return static_cast<const char*>(address) < begin + record.size ? it->second : nullptr;
+  }
+
+ public:
+  static SharedPtrTracker& Instance() {
+    static auto* tracker = new SharedPtrTracker();
+    return *tracker;
+  }
+
+  void AddCounter(const void* counter, const void* object, std::size_t size, const char* type_name,
+                  int (*use_count)(const void*)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_[counter] = {object, size, type_name, CaptureStack(), use_count};
+    objects_[object] = counter;
+  }
+
+  void RemoveCounter(const void* counter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counters_.find(counter);
+    if (it != counters_.end()) {
+      objects_.erase(it->second.object);
+      counters_.erase(it);
+    }
+  }
+
+  void AddSlot(const void* slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.insert(slot);
+  }
+
+  void RemoveSlot(const void* slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.erase(slot);
+  }
+
+  std::vector<TrackedObject> LiveObjects() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TrackedObject> result;
+    result.reserve(counters_.size());
+    for (const auto& [counter, record] : counters_) {
+      result.push_back(Describe(counter, record));
+    }
+    return result;
+  }
+
+  // Prints live objects grouped by type and creation stack, largest groups first.
+  void DumpLive(std::ostream& os) const {
+    std::map<std::pair<std::string, uint64_t>, std::size_t> groups;
+    for (const TrackedObject& object : LiveObjects()) {
+      ++groups[{object.type_name, object.stack_id}];
+    }
+    std::vector<std::pair<std::size_t, std::pair<std::string, uint64_t>>> sorted;
+    for (const auto& [key, count] : groups) {
+      sorted.emplace_back(count, key);
+    }
+    std::sort(sorted.rbegin(), sorted.rend());
+    for (const auto& [count, key] : sorted) {
+      os << count << " x " << key.first << " (stack " << std::hex << key.second << std::dec << ")\n";
+    }
+  }
+
+  void PrintStack(uint64_t stack_id, std::ostream& os) const {
+#ifdef SHARED_PTR_TRACKING_BACKTRACE
+    std::vector<void*> frames;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = stacks_.find(stack_id);
+      if (it == stacks_.end()) {
+        return;
+      }
+      frames = it->second;
+    }
+    char** symbols = backtrace_symbols(frames.data(), static_cast<int>(frames.size()));
+    for (std::size_t i = 0; i != frames.size(); ++i) {
+      os << "  " << (symbols ? symbols[i] : "?") << '\n';
+    }
+    std::free(symbols);
+#else
+    (void)stack_id;
+    (void)os;
+#endif
+  }
+
+  // Strongly connected components of the ownership graph that contain a cycle (Tarjan's algorithm). Must be
+  // called while no other thread is changing the tracked pointers. Cycles through container members are not
+  // seen; see the note at the top of this file.
+  std::vector<TrackedCycle> FindCycles() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const void*> nodes;
+    std::unordered_map<const void*, std::size_t> index_of;
+    for (const auto& entry : counters_) {
+      index_of.emplace(entry.first, nodes.size());
+      nodes.push_back(entry.first);
+    }
+    std::vector<std::vector<std::size_t>> edges(nodes.size());
+    for (const void* slot : slots_) {
+      const void* target = nullptr;
+      std::memcpy(&target, slot, sizeof(target));
+      auto target_it = index_of.find(target);
+      const void* owner = target_it == index_of.end() ? nullptr : Owner(slot);
+      if (owner) {
+        edges[index_of[owner]].push_back(target_it->second);
+      }
+    }
+
+    constexpr std::size_t kUnvisited = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> order(nodes.size(), kUnvisited);
+    std::vector<std::size_t> low(nodes.size());
+    std::vector<bool> on_stack(nodes.size());
+    std::vector<std::size_t> component(nodes.size(), kUnvisited);
+    std::vector<std::size_t> stack;
+    std::vector<std::pair<std::size_t, std::size_t>> frames;  // node, next edge
+    std::vector<std::vector<std::size_t>> components;
+    std::size_t counter = 0;
+
+    for (std::size_t root = 0; root != nodes.size(); ++root) {
+      if (order[root] != kUnvisited) {
+        continue;
+      }
+      frames.emplace_back(root, 0);
+      while (!frames.empty()) {
+        auto& [node, next] = frames.back();
+        if (next == 0 && order[node] == kUnvisited) {
+          order[node] = low[node] = counter++;
+          stack.push_back(node);
+          on_stack[node] = true;
+        }
+        if (next < edges[node].size()) {
+          std::size_t child = edges[node][next++];
+          if (order[child] == kUnvisited) {
+            frames.emplace_back(child, 0);
+          } else if (on_stack[child]) {
+            low[node] = std::min(low[node], order[child]);
+          }
+          continue;
+        }
+        std::size_t finished = node;
+        frames.pop_back();
+        if (!frames.empty()) {
+          std::size_t parent = frames.back().first;
+          low[parent] = std::min(low[parent], low[finished]);
+        }
+        if (low[finished] == order[finished]) {
+          std::vector<std::size_t> members;
+          std::size_t member;
+          do {
+            member = stack.back();
+            stack.pop_back();
+            on_stack[member] = false;
+            component[member] = components.size();
+            members.push_back(member);
+          } while (member != finished);
+          components.push_back(std::move(members));
+        }
+      }
+    }
+
+    std::vector<TrackedCycle> cycles;
+    for (std::size_t id = 0; id != components.size(); ++id) {
+      const auto& members = components[id];
+      int internal = 0;
+      bool cyclic = members.size() > 1;
+      for (std::size_t member : members) {
+        for (std::size_t child : edges[member]) {
+          cyclic = cyclic || child == member;
+        }
+      }
+      if (!cyclic) {
+        continue;
+      }
+      TrackedCycle cycle;
+      for (std::size_t member : members) {
+        for (std::size_t child : edges[member]) {
+          internal += component[child] == id;
+        }
+        cycle.objects.push_back(Describe(nodes[member], counters_.at(nodes[member])));
+        cycle.external_references += cycle.objects.back().use_count;
+      }
+      cycle.external_references -= internal;
+      cycles.push_back(std::move(cycle));
+    }
+    return cycles;
+  }
+};
+
+template <typename T>
+void TrackCounter(const void* counter, const T* object, int (*use_count)(const void*)) {
+  SharedPtrTracker::Instance().AddCounter(counter, object, sizeof(T), TrackedTypeName<T>(), use_count);
+}
+
+inline void UntrackCounter(const void* counter) {
+  SharedPtrTracker::Instance().RemoveCounter(counter);
+}
+
+inline void TrackSlot(const void* slot) {
+  SharedPtrTracker::Instance().AddSlot(slot);
+}
+
+inline void UntrackSlot(const void* slot) {
+  SharedPtrTracker::Instance().RemoveSlot(slot);
+}
+
+#else
+
+template <typename T>
+void TrackCounter(const void*, const T*, int (*)(const void*)) {
+}
+
+inline void UntrackCounter(const void*) {
+}
+
+inline void TrackSlot(const void*) {
+}
+
+inline void UntrackSlot(const void*) {
+}
+
+#endif
+
+#endif
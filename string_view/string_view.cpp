@@ -1,71 +1,434 @@
 #include "string_view.h"
 
-StringView::StringView() : string_{nullptr}, size_{0} {
+#include <charconv>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace {
+
+constexpr char32_t kReplacementCharacter = 0xFFFD;
+
+// Returns the length of the well-formed sequence at data, or 0 if it is malformed or truncated.
+std::size_t DecodeUtf8(const unsigned char* data, std::size_t available, char32_t& code_point) {
+  const unsigned char lead = data[0];
+  if (lead < 0x80) {
+    code_point = lead;
+    return 1;
+  }
+  std::size_t length = 0;
+  unsigned char lower = 0x80;
+  unsigned char upper = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    code_point = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    code_point = lead & 0x0F;
+    if (lead == 0xE0) {
+      lower = 0xA0;
+    } else if (lead == 0xED) {
+      upper = 0x9F;
+    }
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    code_point = lead & 0x07;
+    if (lead == 0xF0) {
+      lower = 0x90;
+    } else if (lead == 0xF4) {
+      upper = 0x8F;
+    }
+  } else {
+    return 0;
+  }
+  if (available < length || data[1] < lower || data[1] > upper) {
+    return 0;
+  }
+  for (std::size_t i = 1; i != length; ++i) {
+    if ((data[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+    code_point = (code_point << 6) | (data[i] & 0x3F);
+  }
+  return length;
+}
+
+#if !defined(__SSSE3__)
+bool ValidateUtf8Scalar(const unsigned char* data, std::size_t size) {
+  std::size_t i = 0;
+  while (i != size) {
+    if (size - i >= 8) {
+      std::uint64_t word;
+      std::memcpy(&word, data + i, 8);
+      if ((word & 0x8080808080808080ULL) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+    char32_t code_point;
+    const std::size_t length = DecodeUtf8(data + i, size - i, code_point);
+    if (length == 0) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
 }
+#endif
+
+#if defined(__SSSE3__)
+// Lookup-table validator of Keiser and Lemire: every error class is a bit, and a byte pair is
+// malformed iff the three nibble lookups agree on some bit (except for the 3/4-byte continuation case).
+constexpr std::uint8_t kTooShort = 1 << 0;
+constexpr std::uint8_t kTooLong = 1 << 1;
+constexpr std::uint8_t kOverlong3 = 1 << 2;
+constexpr std::uint8_t kTooLarge = 1 << 3;
+constexpr std::uint8_t kSurrogate = 1 << 4;
+constexpr std::uint8_t kOverlong2 = 1 << 5;
+constexpr std::uint8_t kTooLarge1000 = 1 << 6;
+constexpr std::uint8_t kOverlong4 = 1 << 6;
+constexpr std::uint8_t kTwoConts = 1 << 7;
+constexpr std::uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
 
-StringView::StringView(const char* string) : string_{string}, size_{strlen(string)} {
+__m128i HighNibbles(__m128i bytes) {
+  return _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
 }
 
-StringView::StringView(const char* string, std::size_t size) : string_{string}, size_{size} {
+__m128i CheckSpecialCases(__m128i input, __m128i prev1) {
+  const __m128i byte_1_high_table =
+      _mm_setr_epi8(kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTwoConts,
+                    kTwoConts, kTwoConts, kTwoConts, kTooShort | kOverlong2, kTooShort,
+                    kTooShort | kOverlong3 | kSurrogate,
+                    static_cast<char>(kTooShort | kTooLarge | kTooLarge1000 | kOverlong4));
+  const __m128i byte_1_low_table = _mm_setr_epi8(
+      static_cast<char>(kCarry | kOverlong3 | kOverlong2 | kOverlong4), static_cast<char>(kCarry | kOverlong2),
+      static_cast<char>(kCarry), static_cast<char>(kCarry), static_cast<char>(kCarry | kTooLarge),
+      static_cast<char>(kCarry | kTooLarge | kTooLarge1000), static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+      static_cast<char>(kCarry | kTooLarge | kTooLarge1000), static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+      static_cast<char>(kCarry | kTooLarge | kTooLarge1000), static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+      static_cast<char>(kCarry | kTooLarge | kTooLarge1000), static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+      static_cast<char>(kCarry | kTooLarge | kTooLarge1000 | kSurrogate),
+      static_cast<char>(kCarry | kTooLarge | kTooLarge1000), static_cast<char>(kCarry | kTooLarge | kTooLarge1000));
+  const __m128i byte_2_high_table = _mm_setr_epi8(
+      kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4),
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge),
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge),
+      static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge), kTooShort, kTooShort, kTooShort,
+      kTooShort);
+  const __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, HighNibbles(prev1));
+  const __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+  const __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, HighNibbles(input));
+  return _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
 }
 
-const char& StringView::operator[](std::size_t index) const {
-  return string_[index];
+__m128i CheckUtf8Bytes(__m128i input, __m128i prev_input) {
+  const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+  const __m128i special_cases = CheckSpecialCases(input, prev1);
+  const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+  const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+  const __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  const __m128i must_be_continuation =
+      _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80)));
+  return _mm_xor_si128(must_be_continuation, special_cases);
 }
 
-const char& StringView::At(std::size_t index) const {
-  if (index >= size_) {
-    throw StringViewOutOfRange{};
+__m128i IsIncomplete(__m128i input) {
+  const __m128i max_value = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+                                          static_cast<char>(0xC0 - 1));
+  return _mm_subs_epu8(input, max_value);
+}
+
+bool ValidateUtf8(const unsigned char* data, std::size_t size) {
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+  std::size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (_mm_movemask_epi8(input) == 0) {
+      error = _mm_or_si128(error, prev_incomplete);
+    } else {
+      error = _mm_or_si128(error, CheckUtf8Bytes(input, prev_input));
+      prev_incomplete = IsIncomplete(input);
+    }
+    prev_input = input;
+  }
+  // The zero padding of the last block is ASCII, so a sequence truncated by the end of input is reported.
+  alignas(16) unsigned char tail[16] = {};
+  if (i != size) {
+    std::memcpy(tail, data + i, size - i);
   }
-  return string_[index];
+  const __m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+  error = _mm_or_si128(error, CheckUtf8Bytes(input, prev_input));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
 }
+#elif defined(__SSE2__)
+bool ValidateUtf8(const unsigned char* data, std::size_t size) {
+  std::size_t i = 0;
+  while (i + 16 <= size) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (_mm_movemask_epi8(input) == 0) {
+      i += 16;
+      continue;
+    }
+    const std::size_t block_end = i + 16;
+    while (i < block_end) {
+      char32_t code_point;
+      const std::size_t length = DecodeUtf8(data + i, size - i, code_point);
+      if (length == 0) {
+        return false;
+      }
+      i += length;
+    }
+  }
+  return ValidateUtf8Scalar(data + i, size - i);
+}
+#else
+bool ValidateUtf8(const unsigned char* data, std::size_t size) {
+  return ValidateUtf8Scalar(data, size);
+}
+#endif
 
-const char& StringView::Front() const {
-  return string_[0];
+char ToLowerAscii(char symbol) {
+  return (symbol >= 'A' && symbol <= 'Z') ? static_cast<char>(symbol | 0x20) : symbol;
 }
 
-const char& StringView::Back() const {
-  return string_[size_ - 1];
+char ToUpperAscii(char symbol) {
+  return (symbol >= 'a' && symbol <= 'z') ? static_cast<char>(symbol & ~0x20) : symbol;
 }
 
-std::size_t StringView::Size() const {
-  return size_;
+#if defined(__SSE2__)
+// Flips the case bit of every byte in [first, first + 26).
+__m128i FlipCaseInRange(__m128i input, char first) {
+  const __m128i shifted = _mm_sub_epi8(input, _mm_set1_epi8(static_cast<char>(first + 0x80)));
+  const __m128i in_range = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+  return _mm_xor_si128(input, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
 }
 
-std::size_t StringView::Length() const {
-  return size_;
+__m128i ToLowerAscii(__m128i input) {
+  return FlipCaseInRange(input, 'A');
 }
 
-bool StringView::Empty() const {
-  return size_ == 0;
+// Length of the common prefix of lowercased a and b within one block, 16 if they agree.
+unsigned MismatchIgnoreCase(const char* a, const char* b) {
+  const __m128i lhs = ToLowerAscii(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+  const __m128i rhs = ToLowerAscii(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+  const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs))) & 0xFFFF;
+  return mask == 0 ? 16 : __builtin_ctz(mask);
 }
+#endif
 
-const char* StringView::Data() const {
-  return string_;
+void TransformAsciiCase(const char* source, std::size_t size, char* destination, char first) {
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), FlipCaseInRange(input, first));
+  }
+#endif
+  for (; i != size; ++i) {
+    destination[i] = first == 'A' ? ToLowerAscii(source[i]) : ToUpperAscii(source[i]);
+  }
 }
 
-void StringView::Swap(StringView& str) {
-  const char* placeholder = string_;
-  string_ = str.string_;
-  str.string_ = placeholder;
-  std::size_t size_ph = size_;
-  size_ = str.size_;
-  str.size_ = size_ph;
+// Lowercases the ASCII letters of eight packed bytes; bytes with the high bit set are left alone.
+std::uint64_t ToLowerAsciiWord(std::uint64_t word) {
+  constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+  constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+  const std::uint64_t heptets = word & ~kHighBits;
+  const std::uint64_t is_above_z = heptets + kOnes * (0x7F - 'Z');
+  const std::uint64_t is_at_least_a = heptets + kOnes * (0x80 - 'A');
+  const std::uint64_t is_upper = ~word & (is_at_least_a ^ is_above_z) & kHighBits;
+  return word | (is_upper >> 2);
 }
 
-void StringView::RemovePrefix(std::size_t prefix_size) {
-  string_ += prefix_size;
-  size_ -= prefix_size;
+std::uint64_t MixHash(std::uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ULL;
+  hash ^= hash >> 33;
+  return hash;
 }
 
-void StringView::RemoveSuffix(std::size_t suffix_size) {
-  size_ -= suffix_size;
+template <typename WordTransform>
+std::size_t HashWords(const char* data, std::size_t size, WordTransform transform) {
+  constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+  std::uint64_t hash = size * kMultiplier;
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    hash = (hash ^ transform(word)) * kMultiplier;
+    hash ^= hash >> 29;
+  }
+  if (i != size) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, data + i, size - i);
+    hash = (hash ^ transform(word)) * kMultiplier;
+  }
+  return static_cast<std::size_t>(MixHash(hash));
 }
 
-StringView StringView::Substr(std::size_t pos, std::size_t count = -1) const {
-  if (pos > size_) {
-    throw StringViewOutOfRange{};
+std::size_t CountLeadBytes(const unsigned char* data, std::size_t size) {
+  std::size_t count = 0;
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  // Continuation bytes 0x80..0xBF are exactly the signed bytes below -64.
+  const __m128i threshold = _mm_set1_epi8(-65);
+  for (; i + 16 <= size; i += 16) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(input, threshold)));
+  }
+#endif
+  for (; i != size; ++i) {
+    count += (data[i] & 0xC0) != 0x80;
   }
-  std::size_t substr_len = (count <= (size_ - pos)) ? count : (size_ - pos);
-  return {string_ + pos, substr_len};
+  return count;
+}
+
+}  // namespace
+
+bool StringView::IsValidUtf8() const {
+  return ValidateUtf8(reinterpret_cast<const unsigned char*>(string_), size_);
+}
+
+std::size_t StringView::CountCodePoints() const {
+  return CountLeadBytes(reinterpret_cast<const unsigned char*>(string_), size_);
+}
+
+CodePointRange StringView::CodePoints() const {
+  return {string_, string_ + size_};
+}
+
+bool StringView::ParseInt(int64_t& value) const {
+  const char* end = string_ + size_;
+  auto [ptr, ec] = std::from_chars(string_, end, value);
+  return ec == std::errc{} && ptr == end && size_ != 0;
+}
+
+bool StringView::ParseDouble(double& value) const {
+  const char* end = string_ + size_;
+  auto [ptr, ec] = std::from_chars(string_, end, value);
+  return ec == std::errc{} && ptr == end && size_ != 0;
+}
+
+std::size_t StringView::Hash() const {
+  return HashWords(string_, size_, [](std::uint64_t word) { return word; });
+}
+
+bool StringView::EqualsIgnoreCase(StringView other) const {
+  return size_ == other.size_ && CompareIgnoreCase(other) == 0;
+}
+
+int StringView::CompareIgnoreCase(StringView other) const {
+  const std::size_t common = size_ < other.size_ ? size_ : other.size_;
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= common; i += 16) {
+    const unsigned offset = MismatchIgnoreCase(string_ + i, other.string_ + i);
+    if (offset != 16) {
+      i += offset;
+      break;
+    }
+  }
+#endif
+  for (; i < common; ++i) {
+    const auto lhs = static_cast<unsigned char>(ToLowerAscii(string_[i]));
+    const auto rhs = static_cast<unsigned char>(ToLowerAscii(other.string_[i]));
+    if (lhs != rhs) {
+      return lhs < rhs ? -1 : 1;
+    }
+  }
+  if (size_ == other.size_) {
+    return 0;
+  }
+  return size_ < other.size_ ? -1 : 1;
+}
+
+std::size_t StringView::HashIgnoreCase() const {
+  return HashWords(string_, size_, ToLowerAsciiWord);
+}
+
+std::size_t StringViewHash::operator()(StringView view) const {
+  return view.Hash();
+}
+
+std::size_t StringViewHashIgnoreCase::operator()(StringView view) const {
+  return view.HashIgnoreCase();
+}
+
+bool StringViewEqualIgnoreCase::operator()(StringView lhs, StringView rhs) const {
+  return lhs.EqualsIgnoreCase(rhs);
+}
+
+void AsciiToLower(const char* source, std::size_t size, char* destination) {
+  TransformAsciiCase(source, size, destination, 'A');
+}
+
+void AsciiToUpper(const char* source, std::size_t size, char* destination) {
+  TransformAsciiCase(source, size, destination, 'a');
+}
+
+CodePointIterator::CodePointIterator(const char* pos, const char* end) : pos_{pos}, end_{end} {
+  Decode();
+}
+
+void CodePointIterator::Decode() {
+  if (pos_ == end_) {
+    length_ = 0;
+    return;
+  }
+  length_ = DecodeUtf8(reinterpret_cast<const unsigned char*>(pos_), end_ - pos_, code_point_);
+  if (length_ == 0) {
+    code_point_ = kReplacementCharacter;
+    length_ = 1;
+  }
+}
+
+CodePointIterator::reference CodePointIterator::operator*() const {
+  return code_point_;
+}
+
+CodePointIterator& CodePointIterator::operator++() {
+  pos_ += length_;
+  Decode();
+  return *this;
+}
+
+CodePointIterator CodePointIterator::operator++(int) {
+  auto temp = *this;
+  ++*this;
+  return temp;
+}
+
+const char* CodePointIterator::Position() const {
+  return pos_;
+}
+
+bool operator==(const CodePointIterator& lhs, const CodePointIterator& rhs) {
+  return lhs.pos_ == rhs.pos_;
+}
+
+bool operator!=(const CodePointIterator& lhs, const CodePointIterator& rhs) {
+  return !(lhs == rhs);
+}
+
+CodePointRange::CodePointRange(const char* begin, const char* end) : begin_{begin}, end_{end} {
+}
+
+CodePointIterator CodePointRange::begin() const {
+  return {begin_, end_};
+}
+
+CodePointIterator CodePointRange::end() const {
+  return {end_, end_};
 }
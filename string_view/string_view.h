@@ -2,7 +2,17 @@
 #define STRING_VIEW_H
 
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <string>
+#if __has_include(<compare>)
+#include <compare>
+#endif
+
+class CodePointRange;
+
+class StringViewOutOfRange {};
 
 class StringView {
  private:
@@ -10,29 +20,191 @@ class StringView {
   std::size_t size_{};
 
  public:
-  StringView();
-  StringView(const char*);  // NOLINT
-  StringView(const char*, std::size_t);
+  static constexpr std::size_t kNpos = static_cast<std::size_t>(-1);
+
+  constexpr StringView() noexcept : string_{nullptr}, size_{0} {
+  }
+
+  constexpr StringView(const char* string) : string_{string}, size_{std::char_traits<char>::length(string)} {  // NOLINT
+  }
+
+  constexpr StringView(const char* string, std::size_t size) noexcept : string_{string}, size_{size} {
+  }
+
+  constexpr const char& operator[](std::size_t index) const {
+    return string_[index];
+  }
+
+  constexpr const char& At(std::size_t index) const {
+    if (index >= size_) {
+      throw StringViewOutOfRange{};
+    }
+    return string_[index];
+  }
+
+  constexpr const char& Front() const {
+    return string_[0];
+  }
+
+  constexpr const char& Back() const {
+    return string_[size_ - 1];
+  }
+
+  constexpr std::size_t Size() const noexcept {
+    return size_;
+  }
+
+  constexpr std::size_t Length() const noexcept {
+    return size_;
+  }
 
-  const char& operator[](std::size_t) const;
-  const char& At(std::size_t) const;
-  const char& Front() const;
-  const char& Back() const;
+  constexpr bool Empty() const noexcept {
+    return size_ == 0;
+  }
 
-  std::size_t Size() const;
-  std::size_t Length() const;
+  constexpr const char* Data() const noexcept {
+    return string_;
+  }
 
-  bool Empty() const;
+  constexpr void Swap(StringView& str) noexcept {
+    const char* placeholder = string_;
+    string_ = str.string_;
+    str.string_ = placeholder;
+    std::size_t size_ph = size_;
+    size_ = str.size_;
+    str.size_ = size_ph;
+  }
+
+  constexpr void RemovePrefix(std::size_t prefix_size) {
+    string_ += prefix_size;
+    size_ -= prefix_size;
+  }
+
+  constexpr void RemoveSuffix(std::size_t suffix_size) {
+    size_ -= suffix_size;
+  }
+
+  constexpr StringView Substr(std::size_t pos, std::size_t count = kNpos) const {
+    if (pos > size_) {
+      throw StringViewOutOfRange{};
+    }
+    std::size_t substr_len = (count <= (size_ - pos)) ? count : (size_ - pos);
+    return {string_ + pos, substr_len};
+  }
+
+  constexpr int Compare(StringView other) const noexcept {
+    const std::size_t common = size_ < other.size_ ? size_ : other.size_;
+    const int result = common == 0 ? 0 : std::char_traits<char>::compare(string_, other.string_, common);
+    if (result != 0) {
+      return result;
+    }
+    if (size_ == other.size_) {
+      return 0;
+    }
+    return size_ < other.size_ ? -1 : 1;
+  }
+
+  friend constexpr bool operator==(StringView lhs, StringView rhs) noexcept {
+    return lhs.size_ == rhs.size_ && (lhs.size_ == 0 || std::char_traits<char>::compare(lhs.string_, rhs.string_,
+                                                                                          lhs.size_) == 0);
+  }
+
+  friend constexpr bool operator!=(StringView lhs, StringView rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend constexpr bool operator<(StringView lhs, StringView rhs) noexcept {
+    return lhs.Compare(rhs) < 0;
+  }
+
+  friend constexpr bool operator<=(StringView lhs, StringView rhs) noexcept {
+    return lhs.Compare(rhs) <= 0;
+  }
+
+  friend constexpr bool operator>(StringView lhs, StringView rhs) noexcept {
+    return lhs.Compare(rhs) > 0;
+  }
+
+  friend constexpr bool operator>=(StringView lhs, StringView rhs) noexcept {
+    return lhs.Compare(rhs) >= 0;
+  }
+
+#if defined(__cpp_lib_three_way_comparison)
+  friend constexpr std::strong_ordering operator<=>(StringView lhs, StringView rhs) noexcept {
+    return lhs.Compare(rhs) <=> 0;
+  }
+#endif
 
-  const char* Data() const;
+  bool IsValidUtf8() const;
+  std::size_t CountCodePoints() const;
+  CodePointRange CodePoints() const;
 
-  void Swap(StringView&);
-  void RemovePrefix(std::size_t);
-  void RemoveSuffix(std::size_t);
+  bool ParseInt(int64_t&) const;
+  bool ParseDouble(double&) const;
 
-  StringView Substr(std::size_t, std::size_t) const;
+  std::size_t Hash() const;
+
+  bool EqualsIgnoreCase(StringView) const;
+  int CompareIgnoreCase(StringView) const;
+  std::size_t HashIgnoreCase() const;
 };
 
-class StringViewOutOfRange {};
+struct StringViewHash {
+  std::size_t operator()(StringView) const;
+};
+
+struct StringViewHashIgnoreCase {
+  std::size_t operator()(StringView) const;
+};
+
+struct StringViewEqualIgnoreCase {
+  bool operator()(StringView, StringView) const;
+};
+
+// Both write exactly size bytes to destination, which may alias source.
+void AsciiToLower(const char* source, std::size_t size, char* destination);
+void AsciiToUpper(const char* source, std::size_t size, char* destination);
+
+// Decodes UTF-8 one code point at a time; malformed sequences yield U+FFFD and advance by one byte.
+class CodePointIterator {
+ private:
+  const char* pos_{};
+  const char* end_{};
+  char32_t code_point_{};
+  std::size_t length_{};
+
+  void Decode();
+
+ public:
+  using difference_type = std::ptrdiff_t;               // NOLINT
+  using value_type = char32_t;                          // NOLINT
+  using pointer = void;                                 // NOLINT
+  using reference = char32_t;                           // NOLINT
+  using iterator_category = std::forward_iterator_tag;  // NOLINT
+
+  CodePointIterator() = default;
+  CodePointIterator(const char*, const char*);
+
+  reference operator*() const;
+  CodePointIterator& operator++();
+  CodePointIterator operator++(int);
+
+  const char* Position() const;
+
+  friend bool operator==(const CodePointIterator&, const CodePointIterator&);
+  friend bool operator!=(const CodePointIterator&, const CodePointIterator&);
+};
+
+class CodePointRange {
+ private:
+  const char* begin_{};
+  const char* end_{};
+
+ public:
+  CodePointRange(const char*, const char*);
+
+  CodePointIterator begin() const;  // NOLINT
+  CodePointIterator end() const;    // NOLINT
+};
 
 #endif
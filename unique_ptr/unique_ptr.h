@@ -1,23 +1,73 @@
 #ifndef UNIQUE_PTR_H
 #define UNIQUE_PTR_H
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 template <typename T>
+struct DefaultDelete {
+  DefaultDelete() = default;
+
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  DefaultDelete(const DefaultDelete<U>&) noexcept {  // NOLINT
+  }
+
+  void operator()(T* ptr) const {
+    static_assert(sizeof(T) > 0, "cannot delete an incomplete type");
+    delete ptr;
+  }
+};
+
+template <typename T>
+struct DefaultDelete<T[]> {
+  void operator()(T* ptr) const {
+    static_assert(sizeof(T) > 0, "cannot delete an incomplete type");
+    delete[] ptr;
+  }
+};
+
+// Constructors that leave the deleter default-initialized are disabled for function pointer deleters, which
+// would otherwise be null.
+template <typename Deleter>
+using EnableIfDefaultDeleter =
+    std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>>;
+
+// The deleter is called as deleter(ptr) for a non-null pointer. Stateless deleters take no space, so
+// UniquePtr<T> stays one pointer wide.
+template <typename T, typename Deleter = DefaultDelete<T>>
 class UniquePtr {
  private:
   T* data_ = nullptr;
+  [[no_unique_address]] Deleter deleter_;
+
+  template <typename U, typename E>
+  friend class UniquePtr;
 
  public:
+  template <typename D = Deleter, typename = EnableIfDefaultDeleter<D>>
   UniquePtr() : data_{nullptr} {};
+  template <typename D = Deleter, typename = EnableIfDefaultDeleter<D>>
   explicit UniquePtr(T* ptr) : data_{ptr} {};
+  UniquePtr(T* ptr, Deleter deleter) : data_{ptr}, deleter_{std::move(deleter)} {};
 
   explicit UniquePtr(const UniquePtr& source) = delete;
   UniquePtr& operator=(const UniquePtr& source) = delete;
 
   ~UniquePtr() {
-    delete data_;
+    if (data_) {
+      deleter_(data_);
+    }
   }
 
-  UniquePtr(UniquePtr&& source) noexcept {
+  UniquePtr(UniquePtr&& source) noexcept : deleter_{std::move(source.deleter_)} {
+    data_ = source.data_;
+    source.data_ = nullptr;
+  }
+
+  template <typename U, typename E,
+            typename = std::enable_if_t<std::is_convertible_v<U*, T*> && std::is_convertible_v<E, Deleter>>>
+  UniquePtr(UniquePtr<U, E>&& source) noexcept : deleter_{std::move(source.deleter_)} {  // NOLINT
     data_ = source.data_;
     source.data_ = nullptr;
   }
@@ -26,9 +76,8 @@ class UniquePtr {
     if (this == &source) {
       return *this;
     }
-    delete data_;
-    data_ = source.data_;
-    source.data_ = nullptr;
+    Reset(source.Release());
+    deleter_ = std::move(source.deleter_);
     return *this;
   }
 
@@ -39,21 +88,31 @@ class UniquePtr {
   }
 
   void Reset(T* ptr = nullptr) {
-    delete data_;
+    T* old = data_;
     data_ = ptr;
+    if (old) {
+      deleter_(old);
+    }
   }
 
-  void Swap(UniquePtr<T>& other) {
-    T* temp = data_;
-    data_ = other.data_;
-    other.data_ = temp;
+  void Swap(UniquePtr& other) {
+    std::swap(data_, other.data_);
+    std::swap(deleter_, other.deleter_);
   }
 
   T* Get() const {
     return data_;
   }
 
-  T& operator*() const {
+  Deleter& GetDeleter() {
+    return deleter_;
+  }
+
+  const Deleter& GetDeleter() const {
+    return deleter_;
+  }
+
+  std::add_lvalue_reference_t<T> operator*() const {
     return *data_;
   }
 
@@ -66,4 +125,103 @@ class UniquePtr {
   }
 };
 
+template <typename T, typename Deleter>
+class UniquePtr<T[], Deleter> {
+ private:
+  T* data_ = nullptr;
+  [[no_unique_address]] Deleter deleter_;
+
+ public:
+  template <typename D = Deleter, typename = EnableIfDefaultDeleter<D>>
+  UniquePtr() : data_{nullptr} {};
+  template <typename D = Deleter, typename = EnableIfDefaultDeleter<D>>
+  explicit UniquePtr(T* ptr) : data_{ptr} {};
+  UniquePtr(T* ptr, Deleter deleter) : data_{ptr}, deleter_{std::move(deleter)} {};
+
+  explicit UniquePtr(const UniquePtr& source) = delete;
+  UniquePtr& operator=(const UniquePtr& source) = delete;
+
+  ~UniquePtr() {
+    if (data_) {
+      deleter_(data_);
+    }
+  }
+
+  UniquePtr(UniquePtr&& source) noexcept : deleter_{std::move(source.deleter_)} {
+    data_ = source.data_;
+    source.data_ = nullptr;
+  }
+
+  UniquePtr& operator=(UniquePtr&& source) noexcept {
+    if (this == &source) {
+      return *this;
+    }
+    Reset(source.Release());
+    deleter_ = std::move(source.deleter_);
+    return *this;
+  }
+
+  T* Release() {
+    T* temp = data_;
+    data_ = nullptr;
+    return temp;
+  }
+
+  void Reset(T* ptr = nullptr) {
+    T* old = data_;
+    data_ = ptr;
+    if (old) {
+      deleter_(old);
+    }
+  }
+
+  void Swap(UniquePtr& other) {
+    std::swap(data_, other.data_);
+    std::swap(deleter_, other.deleter_);
+  }
+
+  T* Get() const {
+    return data_;
+  }
+
+  Deleter& GetDeleter() {
+    return deleter_;
+  }
+
+  const Deleter& GetDeleter() const {
+    return deleter_;
+  }
+
+  T& operator[](std::size_t index) const {
+    return data_[index];
+  }
+
+  explicit operator bool() const {
+    return static_cast<bool>(data_);
+  }
+};
+
+template <typename T, typename... Args>
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> MakeUnique(Args&&... args) {
+  return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Value-initializes every element.
+template <typename T>
+std::enable_if_t<std::is_array_v<T> && std::extent_v<T> == 0, UniquePtr<T>> MakeUnique(std::size_t size) {
+  return UniquePtr<T>(new std::remove_extent_t<T>[size]());
+}
+
+// Default-initializes, so trivial types are left uninitialized instead of being zeroed.
+template <typename T>
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> MakeUniqueForOverwrite() {
+  return UniquePtr<T>(new T);
+}
+
+template <typename T>
+std::enable_if_t<std::is_array_v<T> && std::extent_v<T> == 0, UniquePtr<T>> MakeUniqueForOverwrite(
+    std::size_t size) {
+  return UniquePtr<T>(new std::remove_extent_t<T>[size]);
+}
+
 #endif
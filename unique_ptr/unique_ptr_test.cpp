@@ -0,0 +1,61 @@
+// g++ -std=c++17 -fsanitize=address,undefined unique_ptr/unique_ptr_test.cpp -o unique_ptr_test
+
+#include <cassert>
+#include <cstdio>
+#include <type_traits>
+
+#include "unique_ptr.h"
+
+namespace {
+
+int deleted = 0;
+
+void CountingDelete(int* ptr) {
+  ++deleted;
+  delete ptr;
+}
+
+void CountingArrayDelete(int* ptr) {
+  ++deleted;
+  delete[] ptr;
+}
+
+using FunctionPtrDeleted = UniquePtr<int, void (*)(int*)>;
+using FunctionPtrArray = UniquePtr<int[], void (*)(int*)>;
+
+// A function pointer deleter must be supplied, since a default-initialized one would be null.
+static_assert(!std::is_default_constructible_v<FunctionPtrDeleted>);
+static_assert(!std::is_constructible_v<FunctionPtrDeleted, int*>);
+static_assert(std::is_constructible_v<FunctionPtrDeleted, int*, void (*)(int*)>);
+static_assert(!std::is_default_constructible_v<FunctionPtrArray>);
+static_assert(!std::is_constructible_v<FunctionPtrArray, int*>);
+static_assert(std::is_default_constructible_v<UniquePtr<int>>);
+static_assert(std::is_constructible_v<UniquePtr<int>, int*>);
+static_assert(sizeof(UniquePtr<int>) == sizeof(int*));
+
+void FunctionPointerDeleter() {
+  {
+    FunctionPtrDeleted ptr(new int(1), &CountingDelete);
+    FunctionPtrArray array(new int[2], &CountingArrayDelete);
+    FunctionPtrDeleted moved(std::move(ptr));
+    assert(*moved == 1 && !ptr);
+  }
+  assert(deleted == 2);
+}
+
+void DefaultDeleter() {
+  UniquePtr<int> ptr = MakeUnique<int>(3);
+  assert(*ptr == 3);
+  ptr.Reset();
+  assert(!ptr);
+  UniquePtr<int[]> array = MakeUnique<int[]>(4);
+  assert(array[3] == 0);
+}
+
+}  // namespace
+
+int main() {
+  FunctionPointerDeleter();
+  DefaultDeleter();
+  std::puts("OK");
+}
@@ -3,12 +3,14 @@
 #define VECTOR_MEMORY_IMPLEMENTED
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <iterator>
 #include <memory>
 #include <new>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 class VectorOutOfRange : public std::out_of_range {
  public:
@@ -16,14 +18,134 @@ class VectorOutOfRange : public std::out_of_range {
   }
 };
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class Vector {
  private:
-  T* vector_;
-  std::size_t size_;
-  std::size_t capacity_;
+  using AllocatorTraits = std::allocator_traits<Allocator>;
+
+  T* vector_{};
+  std::size_t size_{};
+  std::size_t capacity_{};
+  [[no_unique_address]] Allocator allocator_;
+
+  T* Allocate(std::size_t count) {
+    return count == 0 ? nullptr : AllocatorTraits::allocate(allocator_, count);
+  }
+
+  void Deallocate(T* pointer, std::size_t count) {
+    if (pointer != nullptr) {
+      AllocatorTraits::deallocate(allocator_, pointer, count);
+    }
+  }
+
+  // Elements are built and destroyed through the allocator, so a scoped allocator such as
+  // std::pmr::polymorphic_allocator is passed on to elements that take one.
+  template <typename... Args>
+  void Construct(T* pointer, Args&&... args) {
+    AllocatorTraits::construct(allocator_, pointer, std::forward<Args>(args)...);
+  }
+
+  void Destroy(T* first, T* last) noexcept {
+    for (; first != last; ++first) {
+      AllocatorTraits::destroy(allocator_, first);
+    }
+  }
+
+  // Both construct into raw memory and destroy what they built if a constructor throws.
+  template <typename InputIterator>
+  T* UninitializedCopy(InputIterator first, InputIterator last, T* out) {
+    T* current = out;
+    try {
+      for (; first != last; ++first, ++current) {
+        Construct(current, *first);
+      }
+    } catch (...) {
+      Destroy(out, current);
+      throw;
+    }
+    return current;
+  }
+
+  // Value-initializes [first, last) if args is empty, copies args otherwise.
+  template <typename... Args>
+  void UninitializedFill(T* first, T* last, const Args&... args) {
+    T* current = first;
+    try {
+      for (; current != last; ++current) {
+        Construct(current, args...);
+      }
+    } catch (...) {
+      Destroy(first, current);
+      throw;
+    }
+  }
+
+  // Gives the empty vector count elements, built in a new buffer by fill(first, last).
+  template <typename Fill>
+  void Initialize(std::size_t count, Fill&& fill) {
+    T* data = Allocate(count);
+    try {
+      fill(data, data + count);
+    } catch (...) {
+      Deallocate(data, count);
+      throw;
+    }
+    vector_ = data;
+    size_ = count;
+    capacity_ = count;
+  }
+
+  // Appends T(args...) to a full vector. The new element is built in the new buffer before the old ones are
+  // moved, so args may refer to an element of this vector.
+  template <typename... Args>
+  void GrowAndEmplace(Args&&... args) {
+    const SizeType new_capacity = capacity_ == 0 ? 1 : capacity_ * 2;
+    T* data = Allocate(new_capacity);
+    try {
+      Construct(data + size_, std::forward<Args>(args)...);
+    } catch (...) {
+      Deallocate(data, new_capacity);
+      throw;
+    }
+    try {
+      UninitializedCopy(std::make_move_iterator(vector_), std::make_move_iterator(vector_ + size_), data);
+    } catch (...) {
+      Destroy(data + size_, data + size_ + 1);
+      Deallocate(data, new_capacity);
+      throw;
+    }
+    Destroy(vector_, vector_ + size_);
+    Deallocate(vector_, capacity_);
+    vector_ = data;
+    ++size_;
+    capacity_ = new_capacity;
+  }
+
+  // Moves the elements to a buffer of new_capacity, which must be at least size_.
+  void Reallocate(std::size_t new_capacity) {
+    T* data = Allocate(new_capacity);
+    try {
+      UninitializedCopy(std::make_move_iterator(vector_), std::make_move_iterator(vector_ + size_), data);
+    } catch (...) {
+      Deallocate(data, new_capacity);
+      throw;
+    }
+    Destroy(vector_, vector_ + size_);
+    Deallocate(vector_, capacity_);
+    vector_ = data;
+    capacity_ = new_capacity;
+  }
+
+  void Release() noexcept {
+    Destroy(vector_, vector_ + size_);
+    Deallocate(vector_, capacity_);
+    vector_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+  }
 
  public:
+  using AllocatorType = Allocator;
   using ValueType = T;
   using SizeType = std::size_t;
   using Reference = T&;
@@ -38,162 +160,66 @@ class Vector {
   Vector() : vector_{nullptr}, size_{0}, capacity_{0} {
   }
 
-  explicit Vector(SizeType size) {
-    try {
-      vector_ = static_cast<Pointer>(operator new(sizeof(ValueType) * size));
-      size_ = 0;
-      capacity_ = size;
-      for (std::size_t i = 0; i != size; ++i) {
-        new (vector_ + i) ValueType;
-        ++size_;
-      }
-    } catch (...) {
-      std::destroy(vector_, vector_ + size_);
-      operator delete(vector_);
-      vector_ = nullptr;
-      size_ = 0;
-      capacity_ = 0;
-      throw;
-    }
+  explicit Vector(const Allocator& allocator) : vector_{nullptr}, size_{0}, capacity_{0}, allocator_{allocator} {
   }
 
-  Vector(SizeType size, ConstReference value) {
-    if (size == 0) {
-      vector_ = nullptr;
-      size_ = 0;
-      capacity_ = 0;
-    } else {
-      try {
-        vector_ = static_cast<Pointer>(operator new(sizeof(ValueType) * size));
-        size_ = 0;
-        capacity_ = size;
-        for (std::size_t i = 0; i != size; ++i) {
-          new (vector_ + i) ValueType(value);
-          ++size_;
-        }
-      } catch (...) {
-        std::destroy(vector_, vector_ + size_);
-        operator delete(vector_);
-        vector_ = nullptr;
-        size_ = 0;
-        capacity_ = 0;
-        throw;
-      }
-    }
+  explicit Vector(SizeType size, const Allocator& allocator = Allocator()) : allocator_{allocator} {
+    Initialize(size, [this](T* first, T* last) { UninitializedFill(first, last); });
+  }
+
+  Vector(SizeType size, ConstReference value, const Allocator& allocator = Allocator()) : allocator_{allocator} {
+    Initialize(size, [this, &value](T* first, T* last) { UninitializedFill(first, last, value); });
   }
 
   template <class Iterator, class = std::enable_if_t<std::is_base_of_v<
                                 std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>>>
-  Vector(Iterator first, Iterator last) {
-    if ((std::distance(first, last)) == 0) {
-      vector_ = nullptr;
-      size_ = 0;
-      capacity_ = 0;
-    } else {
-      try {
-        vector_ = static_cast<Pointer>(operator new(sizeof(ValueType) * std::distance(first, last)));
-        size_ = 0;
-        capacity_ = std::distance(first, last);
-        std::size_t step = 0;
-        for (auto it = first; it != last; ++it) {
-          new (vector_ + step) ValueType(*it);
-          ++step;
-          ++size_;
-        }
-      } catch (...) {
-        std::destroy(vector_, vector_ + size_);
-        operator delete(vector_);
-        vector_ = nullptr;
-        size_ = 0;
-        capacity_ = 0;
-        throw;
-      }
-    }
+  Vector(Iterator first, Iterator last, const Allocator& allocator = Allocator()) : allocator_{allocator} {
+    Initialize(std::distance(first, last), [this, first, last](T* out, T*) { UninitializedCopy(first, last, out); });
   }
 
-  Vector(std::initializer_list<ValueType> lst) {
-    if (lst.size() == 0) {
-      vector_ = nullptr;
-      size_ = 0;
-      capacity_ = 0;
-    } else {
-      try {
-        vector_ = static_cast<Pointer>(operator new(sizeof(ValueType) * lst.size()));
-        size_ = 0;
-        capacity_ = lst.size();
-        std::size_t step = 0;
-        for (auto&& elem : lst) {
-          new (vector_ + step) ValueType(elem);
-          ++step;
-          ++size_;
-        }
-      } catch (...) {
-        std::destroy(vector_, vector_ + size_);
-        operator delete(vector_);
-        vector_ = nullptr;
-        size_ = 0;
-        capacity_ = 0;
-        throw;
-      }
-    }
+  Vector(std::initializer_list<ValueType> lst, const Allocator& allocator = Allocator()) : allocator_{allocator} {
+    Initialize(lst.size(), [this, lst](T* out, T*) { UninitializedCopy(lst.begin(), lst.end(), out); });
   }
 
   ~Vector() {
-    std::destroy(vector_, vector_ + size_);
-    operator delete(vector_);
-    vector_ = nullptr;
-    size_ = 0;
-    capacity_ = 0;
+    Release();
   }
 
-  Vector(const Vector& other) {
-    if (other.vector_ == nullptr) {
-      vector_ = nullptr;
-      size_ = 0;
-      capacity_ = 0;
-    } else {
-      try {
-        vector_ = static_cast<Pointer>(operator new(sizeof(ValueType) * other.size_));
-        size_ = 0;
-        capacity_ = other.size_;
-        for (std::size_t i = 0; i != other.size_; ++i) {
-          new (vector_ + i) ValueType(other.vector_[i]);
-          ++size_;
-        }
-      } catch (...) {
-        std::destroy(vector_, vector_ + size_);
-        operator delete(vector_);
-        vector_ = nullptr;
-        size_ = 0;
-        capacity_ = 0;
-        throw;
-      }
-    }
+  Vector(const Vector& other)
+      : allocator_{AllocatorTraits::select_on_container_copy_construction(other.allocator_)} {
+    Initialize(other.size_,
+               [this, &other](T* out, T*) { UninitializedCopy(other.vector_, other.vector_ + other.size_, out); });
   }
 
   Vector& operator=(const Vector& other) {
     if (this == &other) {
       return *this;
     }
+    if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value) {
+      if (!AllocatorTraits::is_always_equal::value && !(allocator_ == other.allocator_)) {
+        Release();
+      }
+      allocator_ = other.allocator_;
+    }
     if (capacity_ < other.size_) {
-      Vector<ValueType> help;
-      help.Reserve(other.size_);
-      std::uninitialized_copy(other.vector_, other.vector_ + other.size_, help.vector_);
-      help.size_ = other.size_;
+      Vector help(allocator_);
+      help.Initialize(other.size_, [&help, &other](T* out, T*) {
+        help.UninitializedCopy(other.vector_, other.vector_ + other.size_, out);
+      });
       Swap(help);
     } else if (size_ >= other.size_) {
       std::copy(other.vector_, other.vector_ + other.size_, vector_);
-      std::destroy(vector_ + other.size_, vector_ + size_);
+      Destroy(vector_ + other.size_, vector_ + size_);
       size_ = other.size_;
     } else {
       std::copy(other.vector_, other.vector_ + size_, vector_);
-      std::uninitialized_copy(other.vector_ + size_, other.vector_ + other.size_, vector_ + size_);
+      UninitializedCopy(other.vector_ + size_, other.vector_ + other.size_, vector_ + size_);
       size_ = other.size_;
     }
     return *this;
   }
 
-  Vector(Vector&& other) noexcept {
+  Vector(Vector&& other) noexcept : allocator_{std::move(other.allocator_)} {
     vector_ = other.vector_;
     size_ = other.size_;
     capacity_ = other.capacity_;
@@ -202,13 +228,27 @@ class Vector {
     other.capacity_ = 0;
   }
 
-  Vector& operator=(Vector&& other) noexcept {
+  Vector& operator=(Vector&& other) noexcept(AllocatorTraits::propagate_on_container_move_assignment::value ||
+                                             AllocatorTraits::is_always_equal::value) {
     if (this == &other) {
       return *this;
     }
-    std::destroy(vector_, vector_ + size_);
-    operator delete(vector_);
-    vector_ = nullptr;
+    if constexpr (!AllocatorTraits::propagate_on_container_move_assignment::value) {
+      if (!AllocatorTraits::is_always_equal::value && !(allocator_ == other.allocator_)) {
+        Vector temp(allocator_);
+        temp.Initialize(other.size_, [&temp, &other](T* out, T*) {
+          temp.UninitializedCopy(std::make_move_iterator(other.vector_),
+                                 std::make_move_iterator(other.vector_ + other.size_), out);
+        });
+        Swap(temp);
+        other.Clear();
+        return *this;
+      }
+    }
+    Release();
+    if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value) {
+      allocator_ = std::move(other.allocator_);
+    }
 
     vector_ = other.vector_;
     size_ = other.size_;
@@ -279,7 +319,19 @@ class Vector {
     return vector_;
   }
 
+  AllocatorType GetAllocator() const {
+    return allocator_;
+  }
+
+  // Allocators are exchanged only if they propagate on swap; otherwise they must compare equal, as for the
+  // standard containers, since each buffer has to be freed through the allocator that made it.
   void Swap(Vector& other) {
+    if constexpr (AllocatorTraits::propagate_on_container_swap::value) {
+      using std::swap;
+      swap(allocator_, other.allocator_);
+    } else {
+      assert(AllocatorTraits::is_always_equal::value || allocator_ == other.allocator_);
+    }
     std::swap(vector_, other.vector_);
     std::swap(size_, other.size_);
     std::swap(capacity_, other.capacity_);
@@ -287,118 +339,65 @@ class Vector {
 
   void Reserve(std::size_t new_capacity) {
     if (new_capacity > capacity_) {
-      SizeType size = size_;
-      Vector<ValueType> help;
-      help.vector_ = static_cast<Pointer>(operator new(sizeof(ValueType) * new_capacity));
-      std::uninitialized_move(vector_, vector_ + size_, help.vector_);
-      help.size_ = size;
-      help.capacity_ = new_capacity;
-      help.Swap(*this);
+      Reallocate(new_capacity);
     }
   }
 
   void Resize(SizeType new_size) {
     if (new_size < size_) {
-      std::destroy(vector_ + new_size, vector_ + size_);
+      Destroy(vector_ + new_size, vector_ + size_);
       size_ = new_size;
     } else if (new_size > size_) {
-      if (new_size > capacity_) {
-        Vector<ValueType> temp;
-        SizeType size_init = size_;
-        temp.Reserve(new_size);
-        std::uninitialized_move(vector_, vector_ + size_, temp.vector_);
-        temp.size_ = size_init;
-        for (std::size_t i = size_init; i != new_size; ++i) {
-          ++temp.size_;
-          new (temp.vector_ + i) ValueType;
-        }
-        Swap(temp);
-      } else {
-        std::uninitialized_default_construct(vector_ + size_, vector_ + new_size);
-        size_ = new_size;
-      }
+      Reserve(new_size);
+      UninitializedFill(vector_ + size_, vector_ + new_size);
+      size_ = new_size;
     }
   }
 
   void Resize(SizeType new_size, ConstReference value) {
     if (new_size < size_) {
-      std::destroy(vector_ + new_size, vector_ + size_);
+      Destroy(vector_ + new_size, vector_ + size_);
       size_ = new_size;
     } else if (new_size > size_) {
-      if (new_size > capacity_) {
-        Reserve(new_size);
-      }
-      std::uninitialized_fill(vector_ + size_, vector_ + new_size, value);
+      Reserve(new_size);
+      UninitializedFill(vector_ + size_, vector_ + new_size, value);
       size_ = new_size;
     }
   }
 
   void ShrinkToFit() {
     if (size_ < capacity_) {
-      if (size_ == 0) {
-        operator delete(vector_);
-        vector_ = nullptr;
-        capacity_ = 0;
-      } else {
-        Vector<ValueType> temp;
-        temp.Reserve(size_);
-        std::uninitialized_move(vector_, vector_ + size_, temp.vector_);
-        temp.size_ = size_;
-        Swap(temp);
-      }
+      Reallocate(size_);
     }
   }
 
   void Clear() {
-    std::destroy(vector_, vector_ + size_);
+    Destroy(vector_, vector_ + size_);
     size_ = 0;
   }
 
   void PushBack(ConstReference elem) {
-    if (capacity_ <= size_) {
-      SizeType buffer_size = capacity_ == 0 ? 1 : capacity_ * 2;
-      Vector<ValueType> temp;
-      temp.Reserve(buffer_size);
-      std::uninitialized_copy(vector_, vector_ + size_, temp.vector_);
-      temp.size_ = size_;
-      ++temp.size_;
-      std::uninitialized_fill_n(temp.vector_ + size_, 1, elem);
-      Swap(temp);
-    } else {
-      std::uninitialized_fill_n(vector_ + size_, 1, elem);
-      ++size_;
-    }
+    EmplaceBack(elem);
   }
 
   void PushBack(ValueType&& elem) {
-    if (capacity_ <= size_) {
-      if (capacity_ == 0) {
-        Reserve(capacity_ * 2 + 1);
-      } else {
-        Reserve(capacity_ * 2);
-      }
-    }
-    new (vector_ + size_) ValueType(std::forward<ValueType>(elem));
-    ++size_;
+    EmplaceBack(std::move(elem));
   }
 
   template <typename... Args>
   void EmplaceBack(Args&&... args) {
     if (capacity_ <= size_) {
-      if (capacity_ == 0) {
-        Reserve(capacity_ * 2 + 1);
-      } else {
-        Reserve(capacity_ * 2);
-      }
+      GrowAndEmplace(std::forward<Args>(args)...);
+    } else {
+      Construct(vector_ + size_, std::forward<Args>(args)...);
+      ++size_;
     }
-    new (vector_ + size_) ValueType(std::forward<Args>(args)...);
-    ++size_;
   }
 
   void PopBack() {
     if (size_ != 0) {
       --size_;
-      std::destroy_at(vector_ + size_);
+      AllocatorTraits::destroy(allocator_, vector_ + size_);
     }
   }
 
@@ -0,0 +1,145 @@
+// g++ -std=c++17 -fsanitize=address,undefined vector/vector_test.cpp cppstring/cppstring.cpp string_view/string_view.cpp -o vector_test
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <memory_resource>
+
+#include "../cppstring/cppstring.h"
+#include "vector.h"
+
+namespace {
+
+using ArenaStrings = Vector<String, std::pmr::polymorphic_allocator<String>>;
+
+// Counts what each instance allocated, and travels with the buffer it allocated on swap and copy assignment.
+template <typename T>
+struct TrackingAllocator {
+  using value_type = T;                                           // NOLINT
+  using propagate_on_container_swap = std::true_type;             // NOLINT
+  using propagate_on_container_copy_assignment = std::true_type;  // NOLINT
+
+  int* live;
+
+  explicit TrackingAllocator(int* counter) : live{counter} {
+  }
+
+  template <typename U>
+  TrackingAllocator(const TrackingAllocator<U>& other) : live{other.live} {  // NOLINT
+  }
+
+  T* allocate(std::size_t count) {  // NOLINT
+    ++*live;
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T* ptr, std::size_t count) {  // NOLINT
+    --*live;
+    std::allocator<T>().deallocate(ptr, count);
+  }
+
+  friend bool operator==(const TrackingAllocator& lhs, const TrackingAllocator& rhs) {
+    return lhs.live == rhs.live;
+  }
+
+  friend bool operator!=(const TrackingAllocator& lhs, const TrackingAllocator& rhs) {
+    return !(lhs == rhs);
+  }
+};
+
+void SwapPropagatesAllocator() {
+  int first_live = 0;
+  int second_live = 0;
+  {
+    Vector<int, TrackingAllocator<int>> first(TrackingAllocator<int>{&first_live});
+    Vector<int, TrackingAllocator<int>> second(TrackingAllocator<int>{&second_live});
+    first.PushBack(1);
+    second.PushBack(2);
+    second.PushBack(3);
+    first.Swap(second);
+    assert(first.Size() == 2 && second.Size() == 1 && first[1] == 3 && second[0] == 1);
+    assert(first.GetAllocator().live == &second_live && second.GetAllocator().live == &first_live);
+    first.PushBack(4);
+    second.PushBack(5);
+  }
+  assert(first_live == 0 && second_live == 0);
+}
+
+void CopyAssignmentPropagatesAllocator() {
+  int first_live = 0;
+  int second_live = 0;
+  {
+    Vector<int, TrackingAllocator<int>> first(TrackingAllocator<int>{&first_live});
+    Vector<int, TrackingAllocator<int>> second(TrackingAllocator<int>{&second_live});
+    first.PushBack(1);
+    second.PushBack(2);
+    first = second;
+    assert(first_live == 0 && second_live == 2);
+    assert(first.GetAllocator().live == &second_live && first.Size() == 1 && first[0] == 2);
+  }
+  assert(first_live == 0 && second_live == 0);
+}
+
+void SwapEqualPolymorphicAllocators() {
+  std::pmr::monotonic_buffer_resource resource;
+  Vector<int, std::pmr::polymorphic_allocator<int>> first(&resource);
+  Vector<int, std::pmr::polymorphic_allocator<int>> second(&resource);
+  first.PushBack(1);
+  first.Swap(second);
+  assert(first.Empty() && second.Size() == 1 && second.GetAllocator().resource() == &resource);
+}
+
+// Elements built by the vector, including default-constructed ones, take the vector's arena. The default
+// resource is swapped for one that always throws, so any allocation outside the arena fails the test.
+void ElementsUseVectorResource() {
+  alignas(std::max_align_t) static char buffer[1 << 16];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  const String long_string(64, 'x');
+  std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+  {
+    ArenaStrings strings(&arena);
+    strings.Resize(3);
+    strings[0] += long_string;
+    for (int i = 0; i != 20; ++i) {
+      strings.EmplaceBack(40, 'a');
+      strings.EmplaceBack("a string long enough to need its own buffer");
+      strings.PushBack(long_string);
+      strings.PushBack(strings.Back());
+    }
+    strings.Resize(100, long_string);
+    strings.ShrinkToFit();
+    ArenaStrings counted(10, &arena);
+    counted[9] += long_string;
+    for (const String& string : strings) {
+      assert(string.Resource() == &arena);
+    }
+    assert(counted[9].Resource() == &arena && strings[1].Resource() == &arena);
+    assert(strings[5] == long_string && strings[6] == long_string && strings.Size() == 100);
+  }
+  std::pmr::set_default_resource(previous);
+}
+
+// Copying a vector or a string does not carry over the source's resource, so copies can outlive the arena.
+void CopiesUseDefaultResource() {
+  std::pmr::monotonic_buffer_resource arena;
+  ArenaStrings strings(&arena);
+  strings.EmplaceBack("in the arena");
+  const ArenaStrings copy = strings;
+  assert(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+  assert(copy[0].Resource() == std::pmr::get_default_resource() && copy[0] == strings[0]);
+  const String string = strings[0];
+  assert(string.Resource() == std::pmr::get_default_resource());
+  const String moved(String("moved", &arena));
+  assert(moved.Resource() == &arena);
+}
+
+}  // namespace
+
+int main() {
+  SwapPropagatesAllocator();
+  CopyAssignmentPropagatesAllocator();
+  SwapEqualPolymorphicAllocators();
+  ElementsUseVectorResource();
+  CopiesUseDefaultResource();
+  std::puts("OK");
+}